@@ -0,0 +1,634 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "math/batch.h"
+#include "math/matrix3d.h"
+#include "math/matrix4d.h"
+#include "math/vector2d.h"
+#include "math/vector4d.h"
+
+/* scalar implementations as they were before the SIMD kernels, used as baseline and for result comparison */
+namespace reference
+{
+
+Matrix4D multiply(const Matrix4D& A, const Matrix4D& B)
+{
+    return Matrix4D(A(0,0) * B(0,0) + A(0,1) * B(1,0) + A(0,2) * B(2,0) + A(0,3) * B(3,0),
+                    A(0,0) * B(0,1) + A(0,1) * B(1,1) + A(0,2) * B(2,1) + A(0,3) * B(3,1),
+                    A(0,0) * B(0,2) + A(0,1) * B(1,2) + A(0,2) * B(2,2) + A(0,3) * B(3,2),
+                    A(0,0) * B(0,3) + A(0,1) * B(1,3) + A(0,2) * B(2,3) + A(0,3) * B(3,3),
+
+                    A(1,0) * B(0,0) + A(1,1) * B(1,0) + A(1,2) * B(2,0) + A(1,3) * B(3,0),
+                    A(1,0) * B(0,1) + A(1,1) * B(1,1) + A(1,2) * B(2,1) + A(1,3) * B(3,1),
+                    A(1,0) * B(0,2) + A(1,1) * B(1,2) + A(1,2) * B(2,2) + A(1,3) * B(3,2),
+                    A(1,0) * B(0,3) + A(1,1) * B(1,3) + A(1,2) * B(2,3) + A(1,3) * B(3,3),
+
+                    A(2,0) * B(0,0) + A(2,1) * B(1,0) + A(2,2) * B(2,0) + A(2,3) * B(3,0),
+                    A(2,0) * B(0,1) + A(2,1) * B(1,1) + A(2,2) * B(2,1) + A(2,3) * B(3,1),
+                    A(2,0) * B(0,2) + A(2,1) * B(1,2) + A(2,2) * B(2,2) + A(2,3) * B(3,2),
+                    A(2,0) * B(0,3) + A(2,1) * B(1,3) + A(2,2) * B(2,3) + A(2,3) * B(3,3),
+
+                    A(3,0) * B(0,0) + A(3,1) * B(1,0) + A(3,2) * B(2,0) + A(3,3) * B(3,0),
+                    A(3,0) * B(0,1) + A(3,1) * B(1,1) + A(3,2) * B(2,1) + A(3,3) * B(3,1),
+                    A(3,0) * B(0,2) + A(3,1) * B(1,2) + A(3,2) * B(2,2) + A(3,3) * B(3,2),
+                    A(3,0) * B(0,3) + A(3,1) * B(1,3) + A(3,2) * B(2,3) + A(3,3) * B(3,3));
+}
+
+Vector4D multiply(const Matrix4D& M, const Vector4D& v)
+{
+    return Vector4D(M(0,0) * v[0] + M(0,1) * v[1] + M(0,2) * v[2] + M(0,3) * v[3],
+                    M(1,0) * v[0] + M(1,1) * v[1] + M(1,2) * v[2] + M(1,3) * v[3],
+                    M(2,0) * v[0] + M(2,1) * v[1] + M(2,2) * v[2] + M(2,3) * v[3],
+                    M(3,0) * v[0] + M(3,1) * v[1] + M(3,2) * v[2] + M(3,3) * v[3]);
+}
+
+Matrix4D inverse(const Matrix4D &M)
+{
+    const Vector3D& a = reinterpret_cast<const Vector3D&>(M[0]);
+    const Vector3D& b = reinterpret_cast<const Vector3D&>(M[1]);
+    const Vector3D& c = reinterpret_cast<const Vector3D&>(M[2]);
+    const Vector3D& d = reinterpret_cast<const Vector3D&>(M[3]);
+
+    const float& x = M(3,0);
+    const float& y = M(3,1);
+    const float& z = M(3,2);
+    const float& w = M(3,3);
+
+    Vector3D s = cross(a, b);
+    Vector3D t = cross(c, d);
+    Vector3D u = a * y - b * x;
+    Vector3D v = c * w - d * z;
+
+    float invDet = 1.0f / (dot(s, v) + dot(t, u));
+    s *= invDet;
+    t *= invDet;
+    u *= invDet;
+    v *= invDet;
+
+    Vector3D r0 = cross(b, v) + t * y;
+    Vector3D r1 = cross(v, a) - t * x;
+    Vector3D r2 = cross(d, u) + s * w;
+    Vector3D r3 = cross(u, c) - s * z;
+
+    return (Matrix4D(r0.x, r0.y, r0.z, -dot(b, t),
+                     r1.x, r1.y, r1.z,  dot(a, t),
+                     r2.x, r2.y, r2.z, -dot(d, s),
+                     r3.x, r3.y, r3.z,  dot(c, s)));
+}
+
+}
+
+/* double precision versions of the operations from the float inputs, the accuracy checks measure against these */
+namespace exact
+{
+
+struct Vec3
+{
+    double x, y, z;
+};
+
+Vec3 widen(const Vector3D& v)
+{
+    return {v.x, v.y, v.z};
+}
+
+double dot(const Vec3& a, const Vec3& b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+Vec3 cross(const Vec3& a, const Vec3& b)
+{
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+Vec3 scale(const Vec3& v, double s)
+{
+    return {v.x * s, v.y * s, v.z * s};
+}
+
+Vec3 normalize(const Vec3& v)
+{
+    return scale(v, 1.0 / std::sqrt(dot(v, v)));
+}
+
+Vec3 project(const Vec3& a, const Vec3& b)
+{
+    return scale(b, dot(a, b) / dot(b, b));
+}
+
+Vec3 reject(const Vec3& a, const Vec3& b)
+{
+    Vec3 p = project(a, b);
+    return {a.x - p.x, a.y - p.y, a.z - p.z};
+}
+
+/* row major N x N matrices */
+template<int N>
+struct Mat
+{
+    double m[N][N];
+};
+
+template<int N, typename M>
+Mat<N> widen(const M& A)
+{
+    Mat<N> R;
+    for(int i = 0; i < N; ++i)
+    {
+        for(int j = 0; j < N; ++j)
+        {
+            R.m[i][j] = A(i, j);
+        }
+    }
+    return R;
+}
+
+template<int N>
+Mat<N> multiply(const Mat<N>& A, const Mat<N>& B)
+{
+    Mat<N> R{};
+    for(int i = 0; i < N; ++i)
+    {
+        for(int j = 0; j < N; ++j)
+        {
+            for(int k = 0; k < N; ++k)
+            {
+                R.m[i][j] += A.m[i][k] * B.m[k][j];
+            }
+        }
+    }
+    return R;
+}
+
+/* Gauss-Jordan elimination with partial pivoting */
+template<int N>
+Mat<N> inverse(Mat<N> A)
+{
+    Mat<N> R{};
+    for(int i = 0; i < N; ++i)
+    {
+        R.m[i][i] = 1.0;
+    }
+    for(int col = 0; col < N; ++col)
+    {
+        int pivot = col;
+        for(int row = col + 1; row < N; ++row)
+        {
+            if(std::abs(A.m[row][col]) > std::abs(A.m[pivot][col]))
+            {
+                pivot = row;
+            }
+        }
+        std::swap(A.m[col], A.m[pivot]);
+        std::swap(R.m[col], R.m[pivot]);
+
+        double invPivot = 1.0 / A.m[col][col];
+        for(int j = 0; j < N; ++j)
+        {
+            A.m[col][j] *= invPivot;
+            R.m[col][j] *= invPivot;
+        }
+        for(int row = 0; row < N; ++row)
+        {
+            double f = A.m[row][col];
+            if(row == col || f == 0.0)
+            {
+                continue;
+            }
+            for(int j = 0; j < N; ++j)
+            {
+                A.m[row][j] -= f * A.m[col][j];
+                R.m[row][j] -= f * R.m[col][j];
+            }
+        }
+    }
+    return R;
+}
+
+/* Rodrigues' rotation matrix around the normalized axis a */
+Mat<3> rotation(double r, const Vec3& a)
+{
+    double c = std::cos(r), s = std::sin(r), d = 1.0 - c;
+    return {{{c + d * a.x * a.x,       d * a.x * a.y - s * a.z, d * a.x * a.z + s * a.y},
+             {d * a.x * a.y + s * a.z, c + d * a.y * a.y,       d * a.y * a.z - s * a.x},
+             {d * a.x * a.z - s * a.y, d * a.y * a.z + s * a.x, c + d * a.z * a.z}}};
+}
+
+}
+
+namespace
+{
+
+/* keeps results alive so the measured loops are not optimized away */
+volatile float sSink = 0.0f;
+
+Matrix4D randomMatrix(std::mt19937& rng)
+{
+    /* rotation * scale * translation keeps the matrices well conditioned for the inverse */
+    std::uniform_real_distribution<float> angle(-3.14f, 3.14f);
+    std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+    std::uniform_real_distribution<float> offset(-10.0f, 10.0f);
+
+    return Matrix4D::translation({offset(rng), offset(rng), offset(rng)})
+         * Matrix4D::rotation(angle(rng), normalize(Vector3D(offset(rng), offset(rng), offset(rng) + 20.0f)))
+         * Matrix4D::scale(scale(rng), scale(rng), scale(rng));
+}
+
+float maxDifference(const Matrix4D& A, const Matrix4D& B)
+{
+    float diff = 0.0f;
+    for(int j = 0; j < 4; ++j)
+    {
+        for(int i = 0; i < 4; ++i)
+        {
+            diff = std::max(diff, std::abs(A.n[j][i] - B.n[j][i]));
+        }
+    }
+    return diff;
+}
+
+float maxDifference(const Vector4D& a, const Vector4D& b)
+{
+    return std::max(std::max(std::abs(a.x - b.x), std::abs(a.y - b.y)), std::max(std::abs(a.z - b.z), std::abs(a.w - b.w)));
+}
+
+/* runs op(i) for i in [0, count) repeatedly and returns the average time per call in nanoseconds */
+template<typename Op>
+double measure(std::size_t count, std::size_t repetitions, Op op)
+{
+    auto start = std::chrono::steady_clock::now();
+    for(std::size_t r = 0; r < repetitions; ++r)
+    {
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            op(i);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / double(count * repetitions);
+}
+
+/*
+ * Largest error of a kernel in units in the last place. The unit is the float spacing at the magnitude of the whole
+ * result (its largest component, or an explicit scale), so cancellation in a small component is not blamed on the
+ * kernel. The ideal float result is 0.5 ULP away from the double reference.
+ */
+struct UlpError
+{
+    double max = 0.0;
+
+    void add(float value, double reference, double scale)
+    {
+        float magnitude = float(std::abs(scale));
+        float ulp = std::nextafter(magnitude, std::numeric_limits<float>::infinity()) - magnitude;
+        max = std::max(max, std::abs(double(value) - reference) / std::max(ulp, std::numeric_limits<float>::denorm_min()));
+    }
+
+    void add(const Vector3D& value, const exact::Vec3& reference, double scale = 0.0)
+    {
+        scale = std::max({scale, std::abs(reference.x), std::abs(reference.y), std::abs(reference.z)});
+        add(value.x, reference.x, scale);
+        add(value.y, reference.y, scale);
+        add(value.z, reference.z, scale);
+    }
+
+    template<int N, typename M>
+    void add(const M& value, const exact::Mat<N>& reference)
+    {
+        double scale = 0.0;
+        for(int i = 0; i < N; ++i)
+        {
+            for(int j = 0; j < N; ++j)
+            {
+                scale = std::max(scale, std::abs(reference.m[i][j]));
+            }
+        }
+        for(int i = 0; i < N; ++i)
+        {
+            for(int j = 0; j < N; ++j)
+            {
+                add(value(i, j), reference.m[i][j], scale);
+            }
+        }
+    }
+};
+
+/* time per operation and accuracy of a kernel over arrays of several sizes, failed if above the ULP bound */
+struct Check
+{
+    std::string name;
+    double maxUlp;
+    bool failed = false;
+};
+
+void reportCheck(Check& check, std::size_t size, double ns, const UlpError& error)
+{
+    check.failed |= !(error.max <= check.maxUlp);
+    std::cout << std::left << std::setw(20) << check.name << std::right << std::setw(9) << size << std::fixed
+              << std::setprecision(2) << std::setw(11) << ns << std::setw(12) << 1000.0 / ns
+              << std::setw(10) << std::setprecision(1) << error.max << std::setw(8) << check.maxUlp
+              << (error.max <= check.maxUlp ? "" : "  FAIL") << std::defaultfloat << std::endl;
+}
+
+void report(const std::string& name, double baseline, double optimized, float error)
+{
+    std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(13) << baseline << std::setw(13) << optimized
+              << std::setw(10) << baseline / optimized << "x"
+              << std::setw(14) << std::scientific << error << std::defaultfloat << std::endl;
+}
+
+/* ns/op, throughput and ULP error of the math kernels, returns false if any kernel is less accurate than its bound */
+bool accuracySuite(std::size_t totalOps)
+{
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> coord(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> angle(-3.14f, 3.14f);
+    std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+
+    std::cout << "\n" << std::left << std::setw(20) << "kernel" << std::right << std::setw(9) << "size"
+              << std::setw(11) << "ns/op" << std::setw(12) << "Mop/s" << std::setw(10) << "max ulp" << std::setw(8) << "bound" << std::endl;
+
+    /* the bounds leave room for cancellation in the dot products, which the result magnitude does not capture */
+    std::vector<Check> checks = {
+        {"Matrix4D*Matrix4D", 16.0}, {"inverse(Matrix4D)", 64.0}, {"Matrix3D*Matrix3D", 8.0}, {"inverse(Matrix3D)", 32.0},
+        {"Matrix3D::rotation", 8.0}, {"normalize(Vector3D)", 4.0}, {"cross(Vector3D)", 4.0}, {"project(Vector3D)", 8.0},
+        {"reject(Vector3D)", 8.0}, {"project(Vector2D)", 8.0}, {"reject(Vector2D)", 8.0}, {"transformPoints", 16.0},
+    };
+
+    for(std::size_t size : {std::size_t(64), std::size_t(4096), std::size_t(262144)})
+    {
+        const std::size_t repetitions = std::max<std::size_t>(totalOps / size, 1);
+
+        std::vector<Matrix4D> A(size), B(size);
+        std::vector<Matrix3D> C(size), D(size);
+        std::vector<Vector3D> u(size), v(size), axis(size);
+        std::vector<Vector2D> p(size), q(size);
+        std::vector<float> angles(size);
+        for(std::size_t i = 0; i < size; ++i)
+        {
+            A[i] = randomMatrix(rng);
+            B[i] = randomMatrix(rng);
+            axis[i] = normalize(Vector3D(coord(rng), coord(rng), coord(rng)));
+            angles[i] = angle(rng);
+            C[i] = Matrix3D::rotation(angles[i], axis[i]) * Matrix3D::scale(scale(rng), scale(rng), scale(rng));
+            D[i] = Matrix3D(A[i]);
+            u[i] = Vector3D(coord(rng), coord(rng), coord(rng));
+            v[i] = Vector3D(coord(rng), coord(rng), coord(rng));
+            p[i] = Vector2D(coord(rng), coord(rng));
+            q[i] = Vector2D(coord(rng), coord(rng));
+        }
+
+        auto run = [&](Check& check, auto op, auto accuracy) {
+            UlpError error;
+            for(std::size_t i = 0; i < size; ++i)
+            {
+                accuracy(i, error);
+            }
+            reportCheck(check, size, measure(size, repetitions, op), error);
+        };
+
+        run(checks[0], [&](std::size_t i) { sSink = (A[i] * B[i]).n[3][0]; },
+            [&](std::size_t i, UlpError& e) { e.add<4>(A[i] * B[i], exact::multiply(exact::widen<4>(A[i]), exact::widen<4>(B[i]))); });
+        run(checks[1], [&](std::size_t i) { sSink = inverse(A[i]).n[3][0]; },
+            [&](std::size_t i, UlpError& e) { e.add<4>(inverse(A[i]), exact::inverse(exact::widen<4>(A[i]))); });
+        run(checks[2], [&](std::size_t i) { sSink = (C[i] * D[i]).n[2][0]; },
+            [&](std::size_t i, UlpError& e) { e.add<3>(C[i] * D[i], exact::multiply(exact::widen<3>(C[i]), exact::widen<3>(D[i]))); });
+        run(checks[3], [&](std::size_t i) { sSink = inverse(C[i]).n[2][0]; },
+            [&](std::size_t i, UlpError& e) { e.add<3>(inverse(C[i]), exact::inverse(exact::widen<3>(C[i]))); });
+        run(checks[4], [&](std::size_t i) { sSink = Matrix3D::rotation(angles[i], axis[i]).n[2][0]; },
+            [&](std::size_t i, UlpError& e) { e.add<3>(Matrix3D::rotation(angles[i], axis[i]), exact::rotation(angles[i], exact::widen(axis[i]))); });
+        run(checks[5], [&](std::size_t i) { sSink = normalize(u[i]).x; },
+            [&](std::size_t i, UlpError& e) { e.add(normalize(u[i]), exact::normalize(exact::widen(u[i]))); });
+
+        /* the size of a cross product is |u| |v| even if the result cancels to a short vector */
+        run(checks[6], [&](std::size_t i) { sSink = cross(u[i], v[i]).x; },
+            [&](std::size_t i, UlpError& e) { e.add(cross(u[i], v[i]), exact::cross(exact::widen(u[i]), exact::widen(v[i])), length(u[i]) * length(v[i])); });
+        run(checks[7], [&](std::size_t i) { sSink = project(u[i], v[i]).x; },
+            [&](std::size_t i, UlpError& e) { e.add(project(u[i], v[i]), exact::project(exact::widen(u[i]), exact::widen(v[i])), length(u[i])); });
+        run(checks[8], [&](std::size_t i) { sSink = reject(u[i], v[i]).x; },
+            [&](std::size_t i, UlpError& e) { e.add(reject(u[i], v[i]), exact::reject(exact::widen(u[i]), exact::widen(v[i])), length(u[i])); });
+        run(checks[9], [&](std::size_t i) { sSink = project(p[i], q[i]).x; },
+            [&](std::size_t i, UlpError& e) {
+                Vector2D r = project(p[i], q[i]);
+                e.add(Vector3D(r.x, r.y, 0.0f), exact::project({p[i].x, p[i].y, 0.0}, {q[i].x, q[i].y, 0.0}), length(p[i]));
+            });
+        run(checks[10], [&](std::size_t i) { sSink = reject(p[i], q[i]).x; },
+            [&](std::size_t i, UlpError& e) {
+                Vector2D r = reject(p[i], q[i]);
+                e.add(Vector3D(r.x, r.y, 0.0f), exact::reject({p[i].x, p[i].y, 0.0}, {q[i].x, q[i].y, 0.0}), length(p[i]));
+            });
+
+        /* whole array per call, time and throughput per point */
+        std::vector<Vector3D> transformed(size);
+        UlpError error;
+        transformPoints(A[0], u, transformed);
+        const exact::Mat<4> M = exact::widen<4>(A[0]);
+        for(std::size_t i = 0; i < size; ++i)
+        {
+            exact::Vec3 r = {M.m[0][0] * u[i].x + M.m[0][1] * u[i].y + M.m[0][2] * u[i].z + M.m[0][3],
+                             M.m[1][0] * u[i].x + M.m[1][1] * u[i].y + M.m[1][2] * u[i].z + M.m[1][3],
+                             M.m[2][0] * u[i].x + M.m[2][1] * u[i].y + M.m[2][2] * u[i].z + M.m[2][3]};
+            error.add(transformed[i], r);
+        }
+        double ns = measure(1, repetitions, [&](std::size_t) { transformPoints(A[0], u, transformed); }) / double(size);
+        sSink = transformed.back().x;
+        reportCheck(checks[11], size, ns, error);
+    }
+
+    bool passed = true;
+    for(const Check& check : checks)
+    {
+        passed &= !check.failed;
+    }
+    std::cout << (passed ? "accuracy: all kernels within their ULP bounds" : "accuracy: FAILED") << std::endl;
+    return passed;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t count = 1024;
+    const std::size_t repetitions = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+
+    std::mt19937 rng(42);
+    std::vector<Matrix4D> A(count), B(count);
+    std::vector<Vector4D> v(count);
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        A[i] = randomMatrix(rng);
+        B[i] = randomMatrix(rng);
+        v[i] = Vector4D(A[i](0, 3), B[i](1, 3), A[i](2, 3), 1.0f);
+    }
+
+    std::cout << std::left << std::setw(20) << "kernel" << std::right
+              << std::setw(13) << "baseline ns" << std::setw(13) << "optimized ns"
+              << std::setw(11) << "speedup" << std::setw(14) << "max error" << std::endl;
+
+    {
+        float error = 0.0f;
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            error = std::max(error, maxDifference(reference::multiply(A[i], B[i]), A[i] * B[i]));
+        }
+        double baseline = measure(count, repetitions, [&](std::size_t i) { sSink = reference::multiply(A[i], B[i]).n[3][0]; });
+        double optimized = measure(count, repetitions, [&](std::size_t i) { sSink = (A[i] * B[i]).n[3][0]; });
+        report("Matrix4D*Matrix4D", baseline, optimized, error);
+    }
+
+    {
+        float error = 0.0f;
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            error = std::max(error, maxDifference(reference::multiply(A[i], v[i]), A[i] * v[i]));
+        }
+        double baseline = measure(count, repetitions, [&](std::size_t i) { sSink = reference::multiply(A[i], v[i]).x; });
+        double optimized = measure(count, repetitions, [&](std::size_t i) { sSink = (A[i] * v[i]).x; });
+        report("Matrix4D*Vector4D", baseline, optimized, error);
+    }
+
+    {
+        float error = 0.0f;
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            error = std::max(error, maxDifference(reference::inverse(A[i]), inverse(A[i])));
+        }
+        double baseline = measure(count, repetitions, [&](std::size_t i) { sSink = reference::inverse(A[i]).n[3][0]; });
+        double optimized = measure(count, repetitions, [&](std::size_t i) { sSink = inverse(A[i]).n[3][0]; });
+        report("inverse(Matrix4D)", baseline, optimized, error);
+    }
+
+    /* affine fast paths, baseline is the general 4x4 operation */
+    std::vector<Matrix4D> rigid(count);
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        rigid[i] = Matrix4D::translation({A[i](0, 3), A[i](1, 3), A[i](2, 3)}) * Matrix4D::rotationY(A[i](0, 0)) * Matrix4D::rotationX(B[i](1, 1));
+    }
+
+    auto transposedInverse = [](const Matrix4D& M) {
+        Matrix4D I = inverse(M);
+        return Matrix3D(I(0,0), I(1,0), I(2,0),
+                        I(0,1), I(1,1), I(2,1),
+                        I(0,2), I(1,2), I(2,2));
+    };
+
+    {
+        float error = 0.0f;
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            error = std::max(error, maxDifference(A[i] * B[i], affineMultiply(A[i], B[i])));
+        }
+        double baseline = measure(count, repetitions, [&](std::size_t i) { sSink = (A[i] * B[i]).n[3][0]; });
+        double optimized = measure(count, repetitions, [&](std::size_t i) { sSink = affineMultiply(A[i], B[i]).n[3][0]; });
+        report("affineMultiply", baseline, optimized, error);
+    }
+
+    {
+        float error = 0.0f;
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            error = std::max(error, maxDifference(inverse(A[i]), affineInverse(A[i])));
+        }
+        double baseline = measure(count, repetitions, [&](std::size_t i) { sSink = inverse(A[i]).n[3][0]; });
+        double optimized = measure(count, repetitions, [&](std::size_t i) { sSink = affineInverse(A[i]).n[3][0]; });
+        report("affineInverse", baseline, optimized, error);
+    }
+
+    {
+        float error = 0.0f;
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            error = std::max(error, maxDifference(inverse(rigid[i]), rigidInverse(rigid[i])));
+        }
+        double baseline = measure(count, repetitions, [&](std::size_t i) { sSink = inverse(rigid[i]).n[3][0]; });
+        double optimized = measure(count, repetitions, [&](std::size_t i) { sSink = rigidInverse(rigid[i]).n[3][0]; });
+        report("rigidInverse", baseline, optimized, error);
+    }
+
+    {
+        float error = 0.0f;
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            error = std::max(error, maxDifference(Matrix4D(transposedInverse(A[i])), Matrix4D(normalMatrix(A[i]))));
+        }
+        double baseline = measure(count, repetitions, [&](std::size_t i) { sSink = transposedInverse(A[i]).n[2][0]; });
+        double optimized = measure(count, repetitions, [&](std::size_t i) { sSink = normalMatrix(A[i]).n[2][0]; });
+        report("normalMatrix", baseline, optimized, error);
+    }
+
+    /* batch transforms, baseline is one Matrix4D * Vector4D per point; times are per point */
+    const std::size_t pointCount = 1 << 20;
+    const std::size_t batchRepetitions = std::max<std::size_t>(repetitions / 200, 1);
+    const unsigned int threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+    std::uniform_real_distribution<float> coord(-100.0f, 100.0f);
+    std::vector<Vector3D> points(pointCount), transformed(pointCount), expected(pointCount);
+    std::vector<float> xs(pointCount), ys(pointCount), zs(pointCount);
+    std::vector<float> outXs(pointCount), outYs(pointCount), outZs(pointCount);
+    for(std::size_t i = 0; i < pointCount; ++i)
+    {
+        points[i] = Vector3D(coord(rng), coord(rng), coord(rng));
+        xs[i] = points[i].x;
+        ys[i] = points[i].y;
+        zs[i] = points[i].z;
+    }
+
+    const Matrix4D& M = A[0];
+    double baseline = measure(1, batchRepetitions, [&](std::size_t) {
+        for(std::size_t i = 0; i < pointCount; ++i)
+        {
+            expected[i] = M * Vector4D(points[i], 1.0f);
+        }
+    }) / pointCount;
+
+    auto pointsError = [&]() {
+        float error = 0.0f;
+        for(std::size_t i = 0; i < pointCount; ++i)
+        {
+            error = std::max(error, maxDifference(Vector4D(expected[i], 0.0f), Vector4D(transformed[i], 0.0f)));
+        }
+        return error;
+    };
+    auto streamsError = [&]() {
+        float error = 0.0f;
+        for(std::size_t i = 0; i < pointCount; ++i)
+        {
+            error = std::max(error, maxDifference(Vector4D(expected[i], 0.0f), Vector4D(outXs[i], outYs[i], outZs[i], 0.0f)));
+        }
+        return error;
+    };
+
+    {
+        double optimized = measure(1, batchRepetitions, [&](std::size_t) {
+            transformPoints(M, xs.data(), ys.data(), zs.data(), pointCount, outXs.data(), outYs.data(), outZs.data());
+        }) / pointCount;
+        report("transformPoints SoA", baseline, optimized, streamsError());
+
+        optimized = measure(1, batchRepetitions, [&](std::size_t) {
+            transformPoints(M, xs.data(), ys.data(), zs.data(), pointCount, outXs.data(), outYs.data(), outZs.data(), threadCount);
+        }) / pointCount;
+        report("  x" + std::to_string(threadCount) + " threads", baseline, optimized, streamsError());
+    }
+
+    {
+        double optimized = measure(1, batchRepetitions, [&](std::size_t) { transformPoints(M, points, transformed); }) / pointCount;
+        report("transformPoints AoS", baseline, optimized, pointsError());
+
+        optimized = measure(1, batchRepetitions, [&](std::size_t) { transformPoints(M, points, transformed, threadCount); }) / pointCount;
+        report("  x" + std::to_string(threadCount) + " threads", baseline, optimized, pointsError());
+    }
+
+    return accuracySuite(repetitions * 1000) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "mygl/meshoptimize.h"
+
+/* meshOptimize() on generated meshes: time per call and ACMR before and after, failed if the ACMR does not go down */
+
+namespace
+{
+
+struct Sample
+{
+    std::string name;
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+};
+
+/* n x n quads in row order, the order most exporters write a height field in */
+Sample grid(unsigned int n)
+{
+    Sample sample{"grid " + std::to_string(n) + "x" + std::to_string(n), {}, {}};
+    for(unsigned int y = 0; y <= n; y++)
+    {
+        for(unsigned int x = 0; x <= n; x++)
+        {
+            sample.vertices.push_back({Vector3D(float(x), 0.0f, float(y)), Vector4D(1.0f, 1.0f, 1.0f, 1.0f)});
+        }
+    }
+    for(unsigned int y = 0; y < n; y++)
+    {
+        for(unsigned int x = 0; x < n; x++)
+        {
+            unsigned int i = y * (n + 1) + x;
+            sample.indices.insert(sample.indices.end(), {i, i + n + 1, i + 1, i + 1, i + n + 1, i + n + 2});
+        }
+    }
+    return sample;
+}
+
+/* latitude/longitude sphere with its own vertices per triangle, deduplication has to merge them first */
+Sample sphere(unsigned int rings, unsigned int segments)
+{
+    const float pi = 3.14159265358979f;
+    auto point = [&](unsigned int r, unsigned int s) {
+        float theta = pi * float(r) / float(rings);
+        float phi = 2.0f * pi * float(s % segments) / float(segments);
+        return Vertex{Vector3D(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)),
+                      Vector4D(1.0f, 1.0f, 1.0f, 1.0f)};
+    };
+
+    Sample sample{"sphere " + std::to_string(rings) + "x" + std::to_string(segments) + " unshared", {}, {}};
+    for(unsigned int r = 0; r < rings; r++)
+    {
+        for(unsigned int s = 0; s < segments; s++)
+        {
+            for(Vertex v : {point(r, s), point(r + 1, s), point(r, s + 1), point(r, s + 1), point(r + 1, s), point(r + 1, s + 1)})
+            {
+                sample.indices.push_back((unsigned int) sample.vertices.size());
+                sample.vertices.push_back(v);
+            }
+        }
+    }
+    return sample;
+}
+
+/* triangles in random order, as left behind by tools that sort by material or split and merge meshes */
+Sample shuffled(Sample sample)
+{
+    std::mt19937 rng(42);
+    std::vector<std::array<unsigned int, 3>> triangles(sample.indices.size() / 3);
+    std::copy(sample.indices.begin(), sample.indices.end(), &triangles[0][0]);
+    std::shuffle(triangles.begin(), triangles.end(), rng);
+    std::copy(&triangles[0][0], &triangles[0][0] + sample.indices.size(), sample.indices.begin());
+    sample.name += " shuffled";
+    return sample;
+}
+
+/* positions of every triangle rotated to start at the smallest one (keeps the winding), sorted */
+std::vector<std::array<float, 9>> triangleSet(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+{
+    std::vector<std::array<float, 9>> set;
+    for(std::size_t t = 0; t + 2 < indices.size(); t += 3)
+    {
+        std::array<std::array<float, 3>, 3> corners;
+        for(std::size_t c = 0; c < 3; c++)
+        {
+            const Vector3D& p = vertices[indices[t + c]].pos;
+            corners[c] = {p.x, p.y, p.z};
+        }
+        std::rotate(corners.begin(), std::min_element(corners.begin(), corners.end()), corners.end());
+
+        std::array<float, 9> triangle;
+        std::copy(&corners[0][0], &corners[0][0] + 9, triangle.begin());
+        set.push_back(triangle);
+    }
+    std::sort(set.begin(), set.end());
+    return set;
+}
+
+bool validIndices(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+{
+    return std::all_of(indices.begin(), indices.end(), [&](unsigned int i) { return i < vertices.size(); });
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    const unsigned int repetitions = argc > 1 ? (unsigned int) std::max(1l, std::strtol(argv[1], nullptr, 10)) : 5;
+
+    std::vector<Sample> samples;
+    samples.push_back(grid(256));
+    samples.push_back(shuffled(grid(256)));
+    samples.push_back(sphere(128, 256));
+    samples.push_back(shuffled(sphere(128, 256)));
+
+    std::cout << std::left << std::setw(36) << "mesh" << std::right << std::setw(12) << "triangles" << std::setw(12) << "ms/call"
+              << std::setw(11) << "ACMR" << std::setw(9) << "after" << std::setw(12) << "vertices" << std::setw(9) << "after"
+              << std::setw(8) << "check" << std::endl;
+
+    bool passed = true;
+    for(const Sample& sample : samples)
+    {
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+        MeshOptimizeStats stats;
+
+        double total = 0.0;
+        for(unsigned int r = 0; r < repetitions; r++)
+        {
+            vertices = sample.vertices;
+            indices = sample.indices;
+            auto start = std::chrono::steady_clock::now();
+            stats = meshOptimize(vertices, indices);
+            total += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        /* the optimizer may only reorder, the same triangles have to come out with a lower ACMR */
+        bool ok = stats.acmrAfter < stats.acmrBefore && validIndices(vertices, indices)
+               && triangleSet(vertices, indices) == triangleSet(sample.vertices, sample.indices);
+        passed = passed && ok;
+
+        std::cout << std::left << std::setw(36) << sample.name << std::right << std::setw(12) << sample.indices.size() / 3
+                  << std::fixed << std::setprecision(2) << std::setw(12) << total / repetitions
+                  << std::setprecision(3) << std::setw(11) << stats.acmrBefore << std::setw(9) << stats.acmrAfter
+                  << std::setw(12) << stats.verticesBefore << std::setw(9) << stats.verticesAfter
+                  << std::setw(8) << (ok ? "ok" : "FAILED") << std::endl;
+    }
+
+    std::cout << (passed ? "ACMR: reduced on every mesh" : "ACMR: FAILED") << std::endl;
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
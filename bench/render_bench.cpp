@@ -0,0 +1,404 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "mygl/camera.h"
+#include "mygl/framebuffer.h"
+#include "mygl/geometry.h"
+#include "mygl/mesh.h"
+#include "mygl/mesharena.h"
+#include "mygl/shader.h"
+#include "mygl/uniformbuffer.h"
+
+/* scaling benchmark: N cubes and planes on a grid, drawn along a fixed orbit of the camera */
+
+namespace
+{
+
+enum eDrawMode { DrawUniformRing, DrawArena };
+
+struct Options
+{
+    std::vector<unsigned int> counts = {1, 100, 10000, 100000};
+    unsigned int frames = 300;
+    int width = 1280;
+    int height = 720;
+    eDrawMode mode = DrawUniformRing;
+    bool window = false;
+    std::string csv;
+    std::string json;
+};
+
+struct Result
+{
+    unsigned int objects = 0;
+    unsigned int frames = 0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double mean = 0.0;
+    std::size_t drawCalls = 0;
+    std::size_t triangles = 0;
+};
+
+/* a grid cell of the scene, every other object is a plane */
+struct Object
+{
+    Matrix4D model;
+    bool plane;
+};
+
+void printUsage()
+{
+    std::cout << "usage: render_bench [--objects <n>[,<n>...]] [--frames <n>] [--size <width>x<height>] [--mode ubo|arena]\n"
+                 "                    [--window] [--csv <file>] [--json <file>]\n"
+                 "\n"
+                 "--objects  scene sizes to run, 1 to 1000000 (default 1,100,10000,100000)\n"
+                 "--mode     ubo   = one glDrawElements per object, model matrix from a uniform ring (as assignment_01)\n"
+                 "           arena = all objects in one mesh arena, multi draw (indirect if available)\n"
+                 "--window   render into a visible window instead of a headless framebuffer object\n"
+                 "--csv      append one row per scene size\n"
+                 "--json     write all results as JSON array\n";
+}
+
+bool parseArguments(int argc, char** argv, Options& options)
+{
+    for(int i = 1; i < argc; i++)
+    {
+        const bool hasValue = i + 1 < argc;
+        if(std::strcmp(argv[i], "--objects") == 0 && hasValue)
+        {
+            options.counts.clear();
+            std::stringstream list(argv[++i]);
+            std::string count;
+            while(std::getline(list, count, ','))
+            {
+                unsigned long n = std::strtoul(count.c_str(), nullptr, 10);
+                if(n < 1 || n > 1000000)
+                {
+                    return false;
+                }
+                options.counts.push_back((unsigned int) n);
+            }
+        }
+        else if(std::strcmp(argv[i], "--frames") == 0 && hasValue)
+        {
+            options.frames = (unsigned int) std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if(std::strcmp(argv[i], "--size") == 0 && hasValue)
+        {
+            if(std::sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2 || options.width <= 0 || options.height <= 0)
+            {
+                return false;
+            }
+        }
+        else if(std::strcmp(argv[i], "--mode") == 0 && hasValue)
+        {
+            std::string mode = argv[++i];
+            if(mode != "ubo" && mode != "arena")
+            {
+                return false;
+            }
+            options.mode = mode == "ubo" ? DrawUniformRing : DrawArena;
+        }
+        else if(std::strcmp(argv[i], "--window") == 0)
+        {
+            options.window = true;
+        }
+        else if(std::strcmp(argv[i], "--csv") == 0 && hasValue)
+        {
+            options.csv = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--json") == 0 && hasValue)
+        {
+            options.json = argv[++i];
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return options.frames > 0 && !options.counts.empty();
+}
+
+/* square grid around the origin, cubes and planes alternate */
+std::vector<Object> generateScene(unsigned int count)
+{
+    const unsigned int side = (unsigned int) std::ceil(std::sqrt(double(count)));
+    const float spacing = 3.0f;
+    const float offset = 0.5f * spacing * float(side - 1);
+
+    std::vector<Object> objects(count);
+    for(unsigned int i = 0; i < count; i++)
+    {
+        Vector3D position(float(i % side) * spacing - offset, 0.0f, float(i / side) * spacing - offset);
+        objects[i].plane = i % 2 == 1;
+        objects[i].model = Matrix4D::translation(position);
+    }
+    return objects;
+}
+
+/* nearest rank percentile of sorted values */
+double percentile(const std::vector<double>& sorted, double p)
+{
+    std::size_t rank = std::size_t(p / 100.0 * double(sorted.size()) + 0.5);
+    return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+Result run(GLFWwindow* window, const Options& options, unsigned int count)
+{
+    std::vector<Object> objects = generateScene(count);
+
+    /* one orbit around the grid, looking down on it from a distance that fits the whole grid */
+    const float extent = 1.5f * std::ceil(std::sqrt(float(count))) + 4.0f;
+    Camera camera = cameraCreate(float(options.width), float(options.height), to_radians(45.0f), 0.1f, 8.0f * extent,
+                                 {0.0f, extent, 1.5f * extent}, {0.0f, 0.0f, 0.0f});
+    const Vector2D orbitStep(2.0f * float(options.width) / float(options.frames), 0.0f);
+
+    UniformBuffer cameraBuffer = uniformBufferCreate(sizeof(CameraBlock));
+    ShaderProgram shader;
+    Mesh cubeMesh, planeMesh;
+    UniformRing objectRing;
+    MeshArena arena;
+    std::vector<ArenaDraw> draws;
+
+    Result result;
+    result.objects = count;
+    result.frames = options.frames;
+
+    if(options.mode == DrawUniformRing)
+    {
+        shader = shaderLoad("shader/default_ubo.vert", "shader/default.frag");
+        shaderUniformBlock(shader, "CameraBlock", eBlockIdx::CameraBinding);
+        shaderUniformBlock(shader, "ObjectBlock", eBlockIdx::ObjectBinding);
+        cubeMesh = meshCreate(cube::vertices, cube::indices);
+        planeMesh = meshCreate(quad::vertexPos, quad::indices, Vector4D(0.9f, 0.9f, 0.9f, 1.0f));
+        objectRing = uniformRingCreate(sizeof(ObjectBlock), count);
+        result.drawCalls = count;
+    }
+    else
+    {
+        shader = shaderLoad("shader/instanced.vert", "shader/default.frag");
+        shaderUniformBlock(shader, "CameraBlock", eBlockIdx::CameraBinding);
+        arena = meshArenaCreate(1024, 1024);
+        ArenaMesh cube = meshArenaAdd(arena, cube::vertices, cube::indices);
+        ArenaMesh plane = meshArenaAdd(arena, quad::vertexPos, quad::indices, Vector4D(0.9f, 0.9f, 0.9f, 1.0f));
+        draws.reserve(count);
+        for(const Object& object : objects)
+        {
+            draws.push_back({object.plane ? plane : cube, InstanceData{object.model}});
+        }
+        result.drawCalls = arena.indirect ? 1 : count;
+    }
+    for(const Object& object : objects)
+    {
+        result.triangles += (object.plane ? quad::indices.size() : cube::indices.size()) / 3;
+    }
+
+    glUseProgram(shader.id);
+    shaderUniform(shader, "checkerboard", 0);
+
+    std::vector<double> frameMs;
+    frameMs.reserve(options.frames);
+    for(unsigned int frame = 0; frame < options.frames; frame++)
+    {
+        const auto frameStart = std::chrono::steady_clock::now();
+
+        cameraUpdateOrbit(camera, orbitStep, 0.0f);
+        CameraBlock cameraData;
+        cameraData.proj = cameraProjection(camera);
+        cameraData.view = cameraView(camera);
+        cameraData.viewProj = cameraViewProjection(camera);
+        cameraData.position = Vector4D(camera.position, 1.0f);
+        uniformBufferUpdate(cameraBuffer, &cameraData, sizeof(CameraBlock));
+        uniformBufferBind(cameraBuffer, eBlockIdx::CameraBinding);
+
+        glClearColor(135.0 / 255, 206.0 / 255, 235.0 / 255, 1.0);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        if(options.mode == DrawUniformRing)
+        {
+            uniformRingBegin(objectRing);
+            for(const Object& object : objects)
+            {
+                uniformRingPush(objectRing, ObjectBlock{object.model});
+            }
+            uniformRingUpload(objectRing);
+
+            for(unsigned int i = 0; i < count; i++)
+            {
+                const Mesh& mesh = objects[i].plane ? planeMesh : cubeMesh;
+                uniformRingBind(objectRing, eBlockIdx::ObjectBinding, i);
+                glBindVertexArray(mesh.vao);
+                glDrawElements(GL_TRIANGLES, mesh.size_ibo, mesh.index_type, nullptr);
+            }
+            glBindVertexArray(0);
+            uniformRingEnd(objectRing);
+        }
+        else
+        {
+            meshArenaDraw(arena, draws);
+        }
+
+        /* a frame is complete once the GPU finished it, the swap waits for it in a window without vsync */
+        if(options.window)
+        {
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+        }
+        glFinish();
+
+        frameMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+    }
+    glCheckError();
+    glUseProgram(0);
+
+    if(options.mode == DrawUniformRing)
+    {
+        meshDelete(cubeMesh);
+        meshDelete(planeMesh);
+        uniformRingDelete(objectRing);
+    }
+    else
+    {
+        meshArenaDelete(arena);
+    }
+    shaderDelete(shader);
+    uniformBufferDelete(cameraBuffer);
+
+    std::vector<double> sorted = frameMs;
+    std::sort(sorted.begin(), sorted.end());
+    result.p50 = percentile(sorted, 50.0);
+    result.p95 = percentile(sorted, 95.0);
+    result.p99 = percentile(sorted, 99.0);
+    for(double ms : frameMs)
+    {
+        result.mean += ms / double(frameMs.size());
+    }
+    return result;
+}
+
+double perSecond(std::size_t perFrame, const Result& result)
+{
+    return double(perFrame) * 1000.0 / result.mean;
+}
+
+void writeCsv(const std::string& filepath, const std::vector<Result>& results, const char* mode)
+{
+    /* header only for a new file, so runs of both modes can be collected in one table */
+    const bool exists = std::ifstream(filepath).good();
+    std::ofstream file(filepath, std::ios::app);
+    if(!file)
+    {
+        std::cerr << "could not write " << filepath << std::endl;
+        return;
+    }
+    if(!exists)
+    {
+        file << "mode,objects,frames,p50_ms,p95_ms,p99_ms,mean_ms,draw_calls,triangles,draw_calls_per_s,triangles_per_s\n";
+    }
+    for(const Result& r : results)
+    {
+        file << mode << "," << r.objects << "," << r.frames << "," << r.p50 << "," << r.p95 << "," << r.p99 << "," << r.mean << ","
+             << r.drawCalls << "," << r.triangles << "," << perSecond(r.drawCalls, r) << "," << perSecond(r.triangles, r) << "\n";
+    }
+}
+
+void writeJson(const std::string& filepath, const std::vector<Result>& results, const char* mode)
+{
+    std::ofstream file(filepath);
+    if(!file)
+    {
+        std::cerr << "could not write " << filepath << std::endl;
+        return;
+    }
+    file << "[\n";
+    for(std::size_t i = 0; i < results.size(); i++)
+    {
+        const Result& r = results[i];
+        file << "  {\"mode\": \"" << mode << "\", \"objects\": " << r.objects << ", \"frames\": " << r.frames
+             << ", \"p50_ms\": " << r.p50 << ", \"p95_ms\": " << r.p95 << ", \"p99_ms\": " << r.p99 << ", \"mean_ms\": " << r.mean
+             << ", \"draw_calls\": " << r.drawCalls << ", \"triangles\": " << r.triangles
+             << ", \"draw_calls_per_s\": " << perSecond(r.drawCalls, r) << ", \"triangles_per_s\": " << perSecond(r.triangles, r) << "}"
+             << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    file << "]\n";
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if(!parseArguments(argc, argv, options))
+    {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    GLFWwindow* window = options.window ? windowCreate("render_bench", options.width, options.height)
+                                        : windowCreateHeadless(options.width, options.height);
+    if(!window) { return EXIT_FAILURE; }
+    if(options.window)
+    {
+        glfwSwapInterval(0);
+    }
+
+    Framebuffer target;
+    std::vector<Result> results;
+    const char* mode = options.mode == DrawUniformRing ? "ubo" : "arena";
+    try
+    {
+        if(!options.window)
+        {
+            target = framebufferCreate(options.width, options.height);
+            glBindFramebuffer(GL_FRAMEBUFFER, target.id);
+        }
+        glViewport(0, 0, options.width, options.height);
+        glEnable(GL_DEPTH_TEST);
+
+        std::cout << std::fixed << std::setprecision(3)
+                  << "mode " << mode << ", " << options.frames << " frames " << options.width << "x" << options.height << "\n"
+                  << std::setw(10) << "objects" << std::setw(10) << "p50 ms" << std::setw(10) << "p95 ms" << std::setw(10) << "p99 ms"
+                  << std::setw(12) << "draws" << std::setw(14) << "draws/s" << std::setw(14) << "tris/s" << std::endl;
+        for(unsigned int count : options.counts)
+        {
+            Result r = run(window, options, count);
+            results.push_back(r);
+            std::cout << std::setw(10) << r.objects << std::setw(10) << r.p50 << std::setw(10) << r.p95 << std::setw(10) << r.p99
+                      << std::setw(12) << r.drawCalls << std::setw(14) << std::setprecision(0) << perSecond(r.drawCalls, r)
+                      << std::setw(14) << perSecond(r.triangles, r) << std::setprecision(3) << std::endl;
+        }
+    }
+    catch(const std::exception&)
+    {
+        windowDelete(window);
+        return EXIT_FAILURE;
+    }
+
+    if(!options.window)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        framebufferDelete(target);
+    }
+    windowDelete(window);
+
+    if(!options.csv.empty())
+    {
+        writeCsv(options.csv, results, mode);
+    }
+    if(!options.json.empty())
+    {
+        writeJson(options.json, results, mode);
+    }
+    return EXIT_SUCCESS;
+}
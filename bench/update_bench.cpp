@@ -0,0 +1,140 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "math/matrix4d.h"
+#include "math/transform.h"
+
+/* out of line versions of the operations, see update_bench_calls.cpp */
+namespace calls
+{
+Matrix4D multiply(const Matrix4D& A, const Matrix4D& B);
+Matrix4D rotationX(float r);
+Matrix4D rotationY(float r);
+Matrix4D translation(const Vector3D& v);
+Vector3D add(const Vector3D& a, const Vector3D& b);
+Vector3D scale(const Vector3D& v, float s);
+}
+
+namespace
+{
+
+struct InlineOps
+{
+    static Matrix4D multiply(const Matrix4D& A, const Matrix4D& B) { return A * B; }
+    static Matrix4D rotationX(float r) { return Matrix4D::rotationX(r); }
+    static Matrix4D rotationY(float r) { return Matrix4D::rotationY(r); }
+    static Matrix4D translation(const Vector3D& v) { return Matrix4D::translation(v); }
+    static Vector3D add(const Vector3D& a, const Vector3D& b) { return a + b; }
+    static Vector3D scale(const Vector3D& v, float s) { return v * s; }
+};
+
+struct CallOps
+{
+    static Matrix4D multiply(const Matrix4D& A, const Matrix4D& B) { return calls::multiply(A, B); }
+    static Matrix4D rotationX(float r) { return calls::rotationX(r); }
+    static Matrix4D rotationY(float r) { return calls::rotationY(r); }
+    static Matrix4D translation(const Vector3D& v) { return calls::translation(v); }
+    static Vector3D add(const Vector3D& a, const Vector3D& b) { return calls::add(a, b); }
+    static Vector3D scale(const Vector3D& v, float s) { return calls::scale(v, s); }
+};
+
+/* per object state, mirrors the cube in assignment_1.cpp */
+struct Object
+{
+    Vector3D position;
+    Vector3D velocity;
+    Matrix4D scaling;
+    Matrix4D transformation;
+    Transform transform;
+    Matrix4D modelViewProj;
+};
+
+constexpr Matrix4D sCubeScale = Matrix4D::scale(2.0f, 2.0f, 2.0f);
+constexpr float sSpinRadPerSecond = 3.14159265f / 2.0f;
+
+/* same work as sceneUpdate() and the model matrix setup of sceneDraw() for every object */
+template<typename Ops>
+void frameUpdate(std::vector<Object>& objects, const Matrix4D& viewProj, float elapsedTime)
+{
+    const float angle = sSpinRadPerSecond * elapsedTime;
+
+    for(auto& object : objects)
+    {
+        object.position = Ops::add(object.position, Ops::scale(object.velocity, elapsedTime));
+        object.transformation = Ops::multiply(Ops::multiply(Ops::rotationY(angle), Ops::rotationX(-angle)), object.transformation);
+
+        Matrix4D model = Ops::multiply(Ops::multiply(Ops::translation(object.position), object.transformation), object.scaling);
+        object.modelViewProj = Ops::multiply(viewProj, model);
+    }
+}
+
+/* same update with the orientation kept as quaternion and the model matrix built from the TRS transform */
+void frameUpdateTransform(std::vector<Object>& objects, const Matrix4D& viewProj, float elapsedTime)
+{
+    const float angle = sSpinRadPerSecond * elapsedTime;
+    const Quaternion spin = Quaternion::rotationY(angle) * Quaternion::rotationX(-angle);
+
+    for(auto& object : objects)
+    {
+        object.transform.t += object.velocity * elapsedTime;
+        object.transform.r = normalize(spin * object.transform.r);
+        object.modelViewProj = viewProj * toMatrix4D(object.transform);
+    }
+}
+
+template<typename Update>
+double measure(std::vector<Object> objects, const Matrix4D& viewProj, std::size_t frames, Update update)
+{
+    auto start = std::chrono::steady_clock::now();
+    for(std::size_t frame = 0; frame < frames; ++frame)
+    {
+        update(objects, viewProj, 1.0f / 60.0f);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    /* keep the results alive */
+    volatile float sink = objects.back().modelViewProj.n[3][3];
+    (void) sink;
+
+    return std::chrono::duration<double, std::micro>(end - start).count() / double(frames);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t objectCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+    const std::size_t frames = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> coord(-50.0f, 50.0f);
+
+    std::vector<Object> objects(objectCount);
+    for(auto& object : objects)
+    {
+        object.position = Vector3D(coord(rng), 0.0f, coord(rng));
+        object.velocity = Vector3D(coord(rng), coord(rng), coord(rng)) * 0.01f;
+        object.scaling = sCubeScale;
+        object.transformation = Matrix4D::identity();
+        object.transform = Transform(object.position, Quaternion::identity(), {2.0f, 2.0f, 2.0f});
+    }
+
+    const Matrix4D viewProj = Matrix4D::perspective(0.785f, 16.0f / 9.0f, 0.01f, 500.0f) * Matrix4D::translation({0.0f, -4.0f, -20.0f});
+
+    double outOfLine = measure(objects, viewProj, frames, frameUpdate<CallOps>);
+    double inlined = measure(objects, viewProj, frames, frameUpdate<InlineOps>);
+    double transform = measure(objects, viewProj, frames, frameUpdateTransform);
+
+    std::cout << "objects: " << objectCount << ", frames: " << frames << std::endl;
+    std::cout << std::fixed << std::setprecision(2)
+              << "out of line calls: " << std::setw(10) << outOfLine << " us/frame" << std::endl
+              << "inlined headers:   " << std::setw(10) << inlined << " us/frame" << std::endl
+              << "speedup:           " << std::setw(10) << outOfLine / inlined << "x" << std::endl
+              << "quaternion TRS:    " << std::setw(10) << transform << " us/frame" << std::endl;
+
+    return EXIT_SUCCESS;
+}
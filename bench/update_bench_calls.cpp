@@ -0,0 +1,47 @@
+#include "math/matrix4d.h"
+
+/*
+ * Every math operation used by the per-frame update behind a call into this translation unit. This is how the math
+ * types behaved while they were defined out of line in the src/math sources; update_bench compares it to the inlined
+ * headers.
+ */
+#if defined(_MSC_VER)
+#define BENCH_NOINLINE __declspec(noinline)
+#else
+#define BENCH_NOINLINE __attribute__((noinline))
+#endif
+
+namespace calls
+{
+
+BENCH_NOINLINE Matrix4D multiply(const Matrix4D& A, const Matrix4D& B)
+{
+    return A * B;
+}
+
+BENCH_NOINLINE Matrix4D rotationX(float r)
+{
+    return Matrix4D::rotationX(r);
+}
+
+BENCH_NOINLINE Matrix4D rotationY(float r)
+{
+    return Matrix4D::rotationY(r);
+}
+
+BENCH_NOINLINE Matrix4D translation(const Vector3D& v)
+{
+    return Matrix4D::translation(v);
+}
+
+BENCH_NOINLINE Vector3D add(const Vector3D& a, const Vector3D& b)
+{
+    return a + b;
+}
+
+BENCH_NOINLINE Vector3D scale(const Vector3D& v, float s)
+{
+    return v * s;
+}
+
+}
@@ -1,26 +1,49 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
-
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mygl/assetloader.h"
+#include "mygl/capture.h"
+#include "mygl/framebuffer.h"
+#include "mygl/profiler.h"
 #include "mygl/shader.h"
 #include "mygl/mesh.h"
 #include "mygl/geometry.h"
 #include "mygl/camera.h"
+#include "mygl/uniformbuffer.h"
+#include "math/transform.h"
+#include "math/frustum.h"
 
 /* translation, scale and color for the ground plane */
 namespace groundPlane
 {
-const Vector4D color = {0.9f, 0.9f, 0.9f, 1.0f};
-const Matrix4D scale = Matrix4D::scale(20.0f, 0.0f, 20.0f);
-const Matrix4D trans = Matrix4D::identity();
+constexpr Vector4D color = {0.9f, 0.9f, 0.9f, 1.0f};
+constexpr Matrix4D scale = Matrix4D::scale(20.0f, 0.0f, 20.0f);
+constexpr Matrix4D trans = Matrix4D::identity();
 }
 
-/* translation, scale and color for the scaled cube */
+/* translation and scale for the scaled cube */
 namespace scaledCube
 {
-const Matrix4D scale = Matrix4D::scale(2.0f, 2.0f, 2.0f);
-const Matrix4D trans = Matrix4D::translation({0.0f, 4.0f, 0.0f});
+constexpr Vector3D scale = {2.0f, 2.0f, 2.0f};
+constexpr Vector3D trans = {0.0f, 4.0f, 0.0f};
 }
 
+/* one object submitted by sceneDraw() */
+struct DrawObject
+{
+    const Mesh* mesh;
+    Matrix4D model;
+    bool checkerboard;
+};
+
 /* struct holding all necessary state variables for scene */
 struct
 {
@@ -32,15 +55,35 @@ struct
     Mesh planeMesh;
     Matrix4D planeModelMatrix;
 
-    /* cube mesh and transformations */
+    /* cube mesh and transformation (translation, rotation and scale) */
     Mesh cubeMesh;
-    Matrix4D cubeScalingMatrix;
-    Matrix4D cubeTranslationMatrix;
-    Matrix4D cubeTransformationMatrix;
+    Transform cubeTransform;
     float cubeSpinRadPerSecond;
 
-    /* shader */
+    /* shader and its uniform handles, set up once the asynchronously loaded shader is ready */
+    AssetLoader* loader;
+    AssetHandle<ShaderProgram> shaderAsset;
     ShaderProgram shaderColor;
+    UniformHandle uCheckerboard;
+
+    /* screenshots and image sequences, read back and written without stalling the frame */
+    FrameCapture* capture;
+
+    /* CPU and GPU time of the phases of a frame */
+    Profiler* profiler;
+
+    /* uniform buffers for per frame camera data and per object data */
+    UniformBuffer cameraBuffer;
+    UniformRing objectRing;
+
+    /* reverse-Z renders into this target with a float depth buffer, the window only has 24 bit fixed point depth */
+    Framebuffer depthTarget;
+
+    /* world space bounding spheres of all objects, indices of the visible ones and culling statistics of the last frame */
+    CullSpheres cullSpheres;
+    std::vector<unsigned int> visible;
+    unsigned int visibleCount;
+    unsigned int culledCount;
 } sScene;
 
 /* struct holding all state variables for input */
@@ -51,6 +94,20 @@ struct
     bool buttonPressed[4] = {false, false, false, false};
 } sInput;
 
+/* (re)create the float depth target while reverse-Z is active, delete it otherwise */
+void sceneResizeDepthTarget(int width, int height)
+{
+    if(sScene.depthTarget.id != 0)
+    {
+        framebufferDelete(sScene.depthTarget);
+        sScene.depthTarget = Framebuffer();
+    }
+    if(sScene.camera.reverseZ && width > 0 && height > 0)
+    {
+        sScene.depthTarget = framebufferCreate(width, height, GL_DEPTH_COMPONENT32F);
+    }
+}
+
 /* GLFW callback function for keyboard events */
 void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
@@ -65,7 +122,52 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
     /* make screenshot and save in work directory */
     if(key == GLFW_KEY_P && action == GLFW_PRESS)
     {
-        screenshotToPNG("screenshot.png");
+        captureScreenshot(sScene.capture, "screenshot.png");
+    }
+
+    /* print the average time of each frame phase and write all frames as chrome://tracing JSON to work directory */
+    if(key == GLFW_KEY_T && action == GLFW_PRESS)
+    {
+        std::cout << profilerSummary(sScene.profiler);
+        try
+        {
+            profilerWriteTrace(sScene.profiler, "trace.json");
+        }
+        catch(const std::exception&)
+        {
+            /* already reported, keep running */
+        }
+    }
+
+    /* start or stop capturing every frame as capture_000000.png, capture_000001.png, ... in work directory */
+    if(key == GLFW_KEY_R && action == GLFW_PRESS)
+    {
+        if(captureSequenceActive(sScene.capture))
+        {
+            captureSequenceStop(sScene.capture);
+            std::cout << "capture: " << toString(captureStats(sScene.capture)) << std::endl;
+        }
+        else
+        {
+            captureSequenceStart(sScene.capture, "capture_");
+        }
+    }
+
+    /* print culling statistics of the last frame */
+    if(key == GLFW_KEY_C && action == GLFW_PRESS)
+    {
+        std::cout << "visible: " << sScene.visibleCount << ", culled: " << sScene.culledCount << std::endl;
+    }
+
+    /* toggle reverse-Z depth with an infinite far plane */
+    if(key == GLFW_KEY_Z && action == GLFW_PRESS)
+    {
+        bool reverseZ = !sScene.camera.reverseZ;
+        cameraSetReverseZ(sScene.camera, reverseZ, depthSetup(reverseZ));
+
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        sceneResizeDepthTarget(width, height);
     }
 
     /* input for cube control */
@@ -122,12 +224,12 @@ void mouseScrollCallback(GLFWwindow* window, double xoffset, double yoffset)
 void windowResizeCallback(GLFWwindow* window, int width, int height)
 {
     glViewport(0, 0, width, height);
-    sScene.camera.width = width;
-    sScene.camera.height = height;
+    cameraResize(sScene.camera, width, height);
+    sceneResizeDepthTarget(width, height);
 }
 
 /* function to setup and initialize the whole scene */
-void sceneInit(float width, float height)
+void sceneInit(float width, float height, GLFWwindow* uploadContext)
 {
     /* initialize camera */
     sScene.camera = cameraCreate(width, height, to_radians(45.0f), 0.01f, 500.0f, {10.0f, 14.0f, 10.0f}, {0.0f, 4.0f, 0.0f});
@@ -140,15 +242,40 @@ void sceneInit(float width, float height)
     /* setup transformation matrices for objects */
     sScene.planeModelMatrix = groundPlane::trans * groundPlane::scale;
 
-    sScene.cubeScalingMatrix = scaledCube::scale;
-    sScene.cubeTranslationMatrix = scaledCube::trans;
-
-    sScene.cubeTransformationMatrix = Matrix4D::identity();
+    sScene.cubeTransform = Transform(scaledCube::trans, Quaternion::identity(), scaledCube::scale);
 
     sScene.cubeSpinRadPerSecond = M_PI / 2.0f;
 
-    /* load shader from file */
-    sScene.shaderColor = shaderLoad("shader/default.vert", "shader/default.frag");
+    /* load shader from file in the background, the first frames are drawn before it is ready */
+    sScene.loader = assetLoaderCreate(0, uploadContext);
+    sScene.shaderAsset = assetLoadShader(sScene.loader, "shader/default_ubo.vert", "shader/default.frag");
+
+    /* camera data is uploaded once per frame, object data into one slot per draw */
+    sScene.cameraBuffer = uniformBufferCreate(sizeof(CameraBlock));
+    sScene.objectRing = uniformRingCreate(sizeof(ObjectBlock), 64);
+
+    sScene.capture = captureCreate();
+    sScene.profiler = profilerCreate();
+}
+
+/* function to upload streamed assets within a per frame time budget and set up the ones that became ready */
+void sceneStreamAssets()
+{
+    assetLoaderUpdate(sScene.loader, 2.0);
+
+    if(sScene.shaderColor.id == 0 && assetState(sScene.shaderAsset) == AssetFailed)
+    {
+        throw std::runtime_error("[Scene] " + assetError(sScene.shaderAsset));
+    }
+    if(sScene.shaderColor.id == 0 && assetReady(sScene.shaderAsset))
+    {
+        sScene.shaderColor = assetGet(sScene.shaderAsset);
+        shaderUniformBlock(sScene.shaderColor, "CameraBlock", eBlockIdx::CameraBinding);
+        shaderUniformBlock(sScene.shaderColor, "ObjectBlock", eBlockIdx::ObjectBinding);
+
+        /* resolve uniform handles once, the draw loop does no name lookups */
+        sScene.uCheckerboard = shaderUniformHandle(sScene.shaderColor, "checkerboard");
+    }
 }
 
 /* function to move and update objects in scene (e.g., rotate cube according to user input) */
@@ -170,9 +297,10 @@ void sceneUpdate(float elapsedTime)
         rotationDirY = 1;
     }
 
-    /* udpate cube transformation matrix to include new rotation if one of the keys was pressed */
+    /* udpate cube rotation to include new rotation if one of the keys was pressed, renormalize against drift */
     if (rotationDirX != 0 || rotationDirY != 0) {
-        sScene.cubeTransformationMatrix = Matrix4D::rotationY(rotationDirY * sScene.cubeSpinRadPerSecond * elapsedTime) * Matrix4D::rotationX(rotationDirX * sScene.cubeSpinRadPerSecond * elapsedTime) * sScene.cubeTransformationMatrix;
+        Quaternion& rotation = sScene.cubeTransform.r;
+        rotation = normalize(Quaternion::rotationY(rotationDirY * sScene.cubeSpinRadPerSecond * elapsedTime) * Quaternion::rotationX(rotationDirX * sScene.cubeSpinRadPerSecond * elapsedTime) * rotation);
     }
 }
 
@@ -183,24 +311,69 @@ void sceneDraw()
     glClearColor(135.0 / 255, 206.0 / 255, 235.0 / 255, 1.0);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+    /* nothing to draw with until the shader streamed in */
+    if(sScene.shaderColor.id == 0)
+    {
+        return;
+    }
+
+    /*------------ upload uniform data -------------*/
+    /* camera block once per frame, the camera only recalculates its matrices after it changed */
+    profilerBegin(sScene.profiler, "camera uniforms");
+    CameraBlock camera;
+    camera.proj = cameraProjection(sScene.camera);
+    camera.view = cameraView(sScene.camera);
+    camera.viewProj = cameraViewProjection(sScene.camera);
+    camera.position = Vector4D(sScene.camera.position, 1.0f);
+    uniformBufferUpdate(sScene.cameraBuffer, &camera, sizeof(CameraBlock));
+    uniformBufferBind(sScene.cameraBuffer, eBlockIdx::CameraBinding);
+
+    /* all objects of the scene, the cube model matrix is calculated from its transformation */
+    const DrawObject objects[] = {
+        {&sScene.planeMesh, sScene.planeModelMatrix, true},
+        {&sScene.cubeMesh, toMatrix4D(sScene.cubeTransform), false},
+    };
+
+    profilerEnd(sScene.profiler);
+
+    /*------------ cull objects -------------*/
+    profilerBegin(sScene.profiler, "cull");
+    /* test the world space bounding spheres of all objects against the view frustum at once */
+    sScene.cullSpheres.clear();
+    for(const DrawObject& object : objects)
+    {
+        sScene.cullSpheres.push(transform(object.model, object.mesh->sphere));
+    }
+    sScene.visibleCount = cull(cameraFrustum(sScene.camera), sScene.cullSpheres, sScene.visible);
+    sScene.culledCount = sScene.cullSpheres.size() - sScene.visibleCount;
+    profilerEnd(sScene.profiler);
+
+    /* object blocks of all visible draws with one upload, slot i belongs to sScene.visible[i] */
+    profilerBegin(sScene.profiler, "object uniforms");
+    uniformRingBegin(sScene.objectRing);
+    for(unsigned int index : sScene.visible)
+    {
+        uniformRingPush(sScene.objectRing, ObjectBlock{objects[index].model});
+    }
+    uniformRingUpload(sScene.objectRing);
+    profilerEnd(sScene.profiler);
+
     /*------------ render scene -------------*/
-    /* use shader and set the uniforms (names match the ones in the shader) */
+    /* use shader and select the object slot per draw (handles resolved in sceneInit) */
     {
+        ProfilerScope scope(sScene.profiler, "draw");
         glUseProgram(sScene.shaderColor.id);
-        shaderUniform(sScene.shaderColor, "uProj",  cameraProjection(sScene.camera));
-        shaderUniform(sScene.shaderColor, "uView",  cameraView(sScene.camera));
 
-        /* draw ground plane */
-        shaderUniform(sScene.shaderColor, "uModel", sScene.planeModelMatrix);
-        shaderUniform(sScene.shaderColor, "checkerboard", true);
-        glBindVertexArray(sScene.planeMesh.vao);
-        glDrawElements(GL_TRIANGLES, sScene.planeMesh.size_ibo, GL_UNSIGNED_INT, nullptr);
+        for(unsigned int slot = 0; slot < sScene.visibleCount; slot++)
+        {
+            const DrawObject& object = objects[sScene.visible[slot]];
 
-        /* draw cube, requires to calculate the final model matrix from all transformations */
-        shaderUniform(sScene.shaderColor, "uModel", sScene.cubeTranslationMatrix * sScene.cubeTransformationMatrix * sScene.cubeScalingMatrix);
-        shaderUniform(sScene.shaderColor, "checkerboard", false);
-        glBindVertexArray(sScene.cubeMesh.vao);
-        glDrawElements(GL_TRIANGLES, sScene.cubeMesh.size_ibo, GL_UNSIGNED_INT, nullptr);
+            uniformRingBind(sScene.objectRing, eBlockIdx::ObjectBinding, slot);
+            shaderUniform(sScene.shaderColor, sScene.uCheckerboard, object.checkerboard);
+            glBindVertexArray(object.mesh->vao);
+            glDrawElements(GL_TRIANGLES, object.mesh->size_ibo, object.mesh->index_type, nullptr);
+        }
+        uniformRingEnd(sScene.objectRing);
     }
 
     /* cleanup opengl state */
@@ -208,12 +381,183 @@ void sceneDraw()
     glUseProgram(0);
 }
 
+/* command line options of a headless run */
+struct HeadlessOptions
+{
+    bool enabled = false;
+    unsigned int frames = 0;
+    std::string image;
+    std::string timings;
+    std::string trace;
+    bool reverseZ = false;
+};
+
+void printUsage()
+{
+    std::cout << "usage: assignment_01 [--headless <frames>] [--size <width>x<height>] [--image <file.png>]\n"
+                 "                     [--timings <file.csv>] [--trace <file.json>] [--reverse-z]\n"
+                 "\n"
+                 "--headless  render <frames> frames uncapped into a framebuffer object without showing a window\n"
+                 "--size      framebuffer size, default 1280x720\n"
+                 "--image     save the last frame (headless)\n"
+                 "--timings   write the time of every frame in ms (headless)\n"
+                 "--trace     write the profiler events as chrome://tracing JSON (headless)\n"
+                 "--reverse-z reverse-Z projection with a 32 bit float depth buffer (headless)\n";
+}
+
+bool parseArguments(int argc, char** argv, HeadlessOptions& headless, int& width, int& height)
+{
+    for(int i = 1; i < argc; i++)
+    {
+        const bool hasValue = i + 1 < argc;
+        if(std::strcmp(argv[i], "--headless") == 0 && hasValue)
+        {
+            headless.enabled = true;
+            headless.frames = (unsigned int) std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if(std::strcmp(argv[i], "--size") == 0 && hasValue)
+        {
+            if(std::sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0)
+            {
+                return false;
+            }
+        }
+        else if(std::strcmp(argv[i], "--image") == 0 && hasValue)
+        {
+            headless.image = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--timings") == 0 && hasValue)
+        {
+            headless.timings = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--trace") == 0 && hasValue)
+        {
+            headless.trace = argv[++i];
+        }
+        else if(std::strcmp(argv[i], "--reverse-z") == 0)
+        {
+            headless.reverseZ = true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return !headless.enabled || headless.frames > 0;
+}
+
+/* nearest rank percentile of sorted values */
+double percentile(const std::vector<double>& sorted, double p)
+{
+    std::size_t rank = std::size_t(p / 100.0 * double(sorted.size()) + 0.5);
+    return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+/* render a fixed number of frames into a framebuffer object as fast as possible and report the frame times */
+void runHeadless(const HeadlessOptions& options, int width, int height)
+{
+    Framebuffer target = framebufferCreate(width, height, options.reverseZ ? GL_DEPTH_COMPONENT32F : GL_DEPTH_COMPONENT24);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.id);
+    if(options.reverseZ)
+    {
+        cameraSetReverseZ(sScene.camera, true, depthSetup(true));
+    }
+    glViewport(0, 0, width, height);
+
+    /* the shader streams in, every measured frame should draw the scene */
+    while(assetLoaderPending(sScene.loader) > 0)
+    {
+        sceneStreamAssets();
+        std::this_thread::yield();
+    }
+    sceneStreamAssets();
+
+    /* fixed time step and the cube spinning as if 'd' was held, so every run renders the same frames */
+    const float timeStep = 1.0f / 60.0f;
+    sInput.buttonPressed[3] = true;
+
+    std::vector<double> frameMs;
+    frameMs.reserve(options.frames);
+    const auto runStart = std::chrono::steady_clock::now();
+    for(unsigned int frame = 0; frame < options.frames; frame++)
+    {
+        if(frame + 1 == options.frames && !options.image.empty())
+        {
+            captureScreenshot(sScene.capture, options.image);
+        }
+
+        const auto frameStart = std::chrono::steady_clock::now();
+        profilerFrameBegin(sScene.profiler);
+
+        profilerBegin(sScene.profiler, "update");
+        sceneUpdate(timeStep);
+        profilerEnd(sScene.profiler);
+
+        profilerBegin(sScene.profiler, "stream assets");
+        sceneStreamAssets();
+        profilerEnd(sScene.profiler);
+        sceneDraw();
+
+        profilerBegin(sScene.profiler, "capture");
+        captureUpdate(sScene.capture);
+        profilerEnd(sScene.profiler);
+
+        /* nothing is swapped, waiting for the GPU keeps it from queuing frames ahead and makes each time complete */
+        profilerBegin(sScene.profiler, "finish");
+        glFinish();
+        profilerEnd(sScene.profiler);
+
+        profilerFrameEnd(sScene.profiler);
+        frameMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    framebufferDelete(target);
+
+    std::vector<double> sorted = frameMs;
+    std::sort(sorted.begin(), sorted.end());
+    std::cout << "headless: " << options.frames << " frames " << width << "x" << height << " in " << seconds << " s ("
+              << double(options.frames) / seconds << " fps)\n"
+              << "frame ms: min " << sorted.front() << ", p50 " << percentile(sorted, 50.0) << ", p95 " << percentile(sorted, 95.0)
+              << ", p99 " << percentile(sorted, 99.0) << ", max " << sorted.back() << "\n"
+              << "shader cache: " << toString(shaderCacheStats()) << "\n"
+              << profilerSummary(sScene.profiler);
+
+    if(!options.timings.empty())
+    {
+        std::ofstream file(options.timings);
+        if(!file)
+        {
+            std::cerr << "[Headless] could not open " << options.timings << " for writing" << std::endl;
+            throw std::runtime_error("[Headless] could not write " + options.timings);
+        }
+        file << "frame,ms\n";
+        for(std::size_t i = 0; i < frameMs.size(); i++)
+        {
+            file << i << "," << frameMs[i] << "\n";
+        }
+    }
+    if(!options.trace.empty())
+    {
+        profilerWriteTrace(sScene.profiler, options.trace);
+    }
+}
+
 int main(int argc, char** argv)
 {
     /* create window/context */
     int width = 1280;
     int height = 720;
-    GLFWwindow* window = windowCreate("Assignment 1 - Transformations, User Input and Camera", width, height);
+    HeadlessOptions headless;
+    if(!parseArguments(argc, argv, headless, width, height))
+    {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    GLFWwindow* window = headless.enabled ? windowCreateHeadless(width, height)
+                                          : windowCreate("Assignment 1 - Transformations, User Input and Camera", width, height);
     if(!window) { return EXIT_FAILURE; }
 
     /* set window callbacks */
@@ -228,8 +572,28 @@ int main(int argc, char** argv)
     glEnable(GL_DEPTH_TEST);
 
 
+    /* linked programs are kept on disk, later starts skip compiling the shaders */
+    shaderCacheSetDirectory("shader_cache");
+
+    /* hidden context for the asset upload thread, uploads run on this thread if it could not be created */
+    GLFWwindow* uploadContext = windowCreateUploadContext(window);
+
     /* setup scene */
-    sceneInit(width, height);
+    sceneInit(width, height, uploadContext);
+
+    int exitCode = EXIT_SUCCESS;
+    if(headless.enabled)
+    {
+        try
+        {
+            runHeadless(headless, width, height);
+        }
+        catch(const std::exception&)
+        {
+            exitCode = EXIT_FAILURE;
+        }
+        glfwSetWindowShouldClose(window, true);
+    }
 
     /*-------------- main loop ----------------*/
     double timeStamp = glfwGetTime();
@@ -238,30 +602,76 @@ int main(int argc, char** argv)
     /* loop until user closes window */
     while(!glfwWindowShouldClose(window))
     {
+        profilerFrameBegin(sScene.profiler);
+
         /* poll and process input and window events */
+        profilerBegin(sScene.profiler, "events");
         glfwPollEvents();
+        profilerEnd(sScene.profiler);
 
         /* update model matrix of cube */
+        profilerBegin(sScene.profiler, "update");
         timeStampNew = glfwGetTime();
         sceneUpdate(timeStampNew - timeStamp);
         timeStamp = timeStampNew;
+        profilerEnd(sScene.profiler);
 
-        /* draw all objects in the scene */
+        /* finish streamed assets and draw all objects in the scene */
+        profilerBegin(sScene.profiler, "stream assets");
+        sceneStreamAssets();
+        profilerEnd(sScene.profiler);
+        glBindFramebuffer(GL_FRAMEBUFFER, sScene.depthTarget.id);
         sceneDraw();
 
+        /* with reverse-Z the frame was drawn into the float depth target, copy its color into the window */
+        if(sScene.depthTarget.id != 0)
+        {
+            ProfilerScope scope(sScene.profiler, "blit");
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, sScene.depthTarget.id);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+            glBlitFramebuffer(0, 0, sScene.depthTarget.width, sScene.depthTarget.height,
+                              0, 0, sScene.depthTarget.width, sScene.depthTarget.height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        }
+
+        /* read back the frame if a screenshot or a sequence is requested */
+        profilerBegin(sScene.profiler, "capture");
+        captureUpdate(sScene.capture);
+        profilerEnd(sScene.profiler);
+
         /* swap front and back buffer */
+        profilerBegin(sScene.profiler, "swap");
         glfwSwapBuffers(window);
+        profilerEnd(sScene.profiler);
+
+        profilerFrameEnd(sScene.profiler);
     }
 
 
     /*-------- cleanup --------*/
-    /* delete opengl shader and buffers */
-    shaderDelete(sScene.shaderColor);
+    /* stop loading and delete opengl shader and buffers */
+    assetLoaderDelete(sScene.loader);
+    captureDelete(sScene.capture);
+    profilerDelete(sScene.profiler);
+    if(sScene.shaderColor.id != 0)
+    {
+        shaderDelete(sScene.shaderColor);
+    }
+    uniformBufferDelete(sScene.cameraBuffer);
+    uniformRingDelete(sScene.objectRing);
+    if(sScene.depthTarget.id != 0)
+    {
+        framebufferDelete(sScene.depthTarget);
+    }
     meshDelete(sScene.planeMesh);
     meshDelete(sScene.cubeMesh);
 
     /* cleanup glfw/glcontext */
+    if(uploadContext)
+    {
+        windowDeleteUploadContext(uploadContext);
+    }
     windowDelete(window);
 
-    return EXIT_SUCCESS;
+    return exitCode;
 }
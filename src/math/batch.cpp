@@ -0,0 +1,120 @@
+#include "batch.h"
+
+#include "parallel.h"
+#include "simd.h"
+
+static_assert(sizeof(Vector3D) == 3 * sizeof(float), "Vector3D arrays are processed as packed float triples");
+
+namespace detail
+{
+
+void transformPointsSoA(const Matrix4D& M, const float* xs, const float* ys, const float* zs,
+                        float* outXs, float* outYs, float* outZs, std::size_t begin, std::size_t end)
+{
+    std::size_t i = begin;
+
+#if defined(MATH_AVX)
+    const __m256 m00 = _mm256_set1_ps(M.n[0][0]), m01 = _mm256_set1_ps(M.n[1][0]), m02 = _mm256_set1_ps(M.n[2][0]), m03 = _mm256_set1_ps(M.n[3][0]);
+    const __m256 m10 = _mm256_set1_ps(M.n[0][1]), m11 = _mm256_set1_ps(M.n[1][1]), m12 = _mm256_set1_ps(M.n[2][1]), m13 = _mm256_set1_ps(M.n[3][1]);
+    const __m256 m20 = _mm256_set1_ps(M.n[0][2]), m21 = _mm256_set1_ps(M.n[1][2]), m22 = _mm256_set1_ps(M.n[2][2]), m23 = _mm256_set1_ps(M.n[3][2]);
+
+    for(; i + 8 <= end; i += 8)
+    {
+        const __m256 x = _mm256_loadu_ps(xs + i);
+        const __m256 y = _mm256_loadu_ps(ys + i);
+        const __m256 z = _mm256_loadu_ps(zs + i);
+
+        _mm256_storeu_ps(outXs + i, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m00, x), _mm256_mul_ps(m01, y)), _mm256_add_ps(_mm256_mul_ps(m02, z), m03)));
+        _mm256_storeu_ps(outYs + i, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m10, x), _mm256_mul_ps(m11, y)), _mm256_add_ps(_mm256_mul_ps(m12, z), m13)));
+        _mm256_storeu_ps(outZs + i, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m20, x), _mm256_mul_ps(m21, y)), _mm256_add_ps(_mm256_mul_ps(m22, z), m23)));
+    }
+#elif defined(MATH_SSE)
+    const __m128 m00 = _mm_set1_ps(M.n[0][0]), m01 = _mm_set1_ps(M.n[1][0]), m02 = _mm_set1_ps(M.n[2][0]), m03 = _mm_set1_ps(M.n[3][0]);
+    const __m128 m10 = _mm_set1_ps(M.n[0][1]), m11 = _mm_set1_ps(M.n[1][1]), m12 = _mm_set1_ps(M.n[2][1]), m13 = _mm_set1_ps(M.n[3][1]);
+    const __m128 m20 = _mm_set1_ps(M.n[0][2]), m21 = _mm_set1_ps(M.n[1][2]), m22 = _mm_set1_ps(M.n[2][2]), m23 = _mm_set1_ps(M.n[3][2]);
+
+    for(; i + 4 <= end; i += 4)
+    {
+        const __m128 x = _mm_loadu_ps(xs + i);
+        const __m128 y = _mm_loadu_ps(ys + i);
+        const __m128 z = _mm_loadu_ps(zs + i);
+
+        _mm_storeu_ps(outXs + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m01, y)), _mm_add_ps(_mm_mul_ps(m02, z), m03)));
+        _mm_storeu_ps(outYs + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m10, x), _mm_mul_ps(m11, y)), _mm_add_ps(_mm_mul_ps(m12, z), m13)));
+        _mm_storeu_ps(outZs + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m20, x), _mm_mul_ps(m21, y)), _mm_add_ps(_mm_mul_ps(m22, z), m23)));
+    }
+#endif
+
+    for(; i < end; ++i)
+    {
+        const float x = xs[i], y = ys[i], z = zs[i];
+        outXs[i] = (M.n[0][0] * x + M.n[1][0] * y) + (M.n[2][0] * z + M.n[3][0]);
+        outYs[i] = (M.n[0][1] * x + M.n[1][1] * y) + (M.n[2][1] * z + M.n[3][1]);
+        outZs[i] = (M.n[0][2] * x + M.n[1][2] * y) + (M.n[2][2] * z + M.n[3][2]);
+    }
+}
+
+void transformPointsAoS(const Matrix4D& M, const Vector3D* points, Vector3D* result, std::size_t begin, std::size_t end)
+{
+    std::size_t i = begin;
+
+#if defined(MATH_SSE)
+    const __m128 m00 = _mm_set1_ps(M.n[0][0]), m01 = _mm_set1_ps(M.n[1][0]), m02 = _mm_set1_ps(M.n[2][0]), m03 = _mm_set1_ps(M.n[3][0]);
+    const __m128 m10 = _mm_set1_ps(M.n[0][1]), m11 = _mm_set1_ps(M.n[1][1]), m12 = _mm_set1_ps(M.n[2][1]), m13 = _mm_set1_ps(M.n[3][1]);
+    const __m128 m20 = _mm_set1_ps(M.n[0][2]), m21 = _mm_set1_ps(M.n[1][2]), m22 = _mm_set1_ps(M.n[2][2]), m23 = _mm_set1_ps(M.n[3][2]);
+
+    /* four points are twelve packed floats: load them as three registers and transpose to x, y and z lanes */
+    for(; i + 4 <= end; i += 4)
+    {
+        const float* src = &points[i].x;
+        const __m128 a = _mm_loadu_ps(src);
+        const __m128 b = _mm_loadu_ps(src + 4);
+        const __m128 c = _mm_loadu_ps(src + 8);
+
+        const __m128 x = MATH_SHUFFLE(a, MATH_SHUFFLE(b, c, 2, 2, 1, 1), 0, 3, 0, 2);
+        const __m128 y = MATH_SHUFFLE(MATH_SHUFFLE(a, b, 1, 1, 0, 0), MATH_SHUFFLE(b, c, 3, 3, 2, 2), 0, 2, 0, 2);
+        const __m128 z = MATH_SHUFFLE(MATH_SHUFFLE(a, b, 2, 2, 1, 1), c, 0, 2, 0, 3);
+
+        const __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m01, y)), _mm_add_ps(_mm_mul_ps(m02, z), m03));
+        const __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m10, x), _mm_mul_ps(m11, y)), _mm_add_ps(_mm_mul_ps(m12, z), m13));
+        const __m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m20, x), _mm_mul_ps(m21, y)), _mm_add_ps(_mm_mul_ps(m22, z), m23));
+
+        float* dst = &result[i].x;
+        _mm_storeu_ps(dst,     MATH_SHUFFLE(MATH_SHUFFLE(rx, ry, 0, 1, 0, 0), MATH_SHUFFLE(rz, rx, 0, 0, 1, 1), 0, 2, 0, 2));
+        _mm_storeu_ps(dst + 4, MATH_SHUFFLE(MATH_SHUFFLE(ry, rz, 1, 1, 1, 1), MATH_SHUFFLE(rx, ry, 2, 2, 2, 2), 0, 2, 0, 2));
+        _mm_storeu_ps(dst + 8, MATH_SHUFFLE(MATH_SHUFFLE(rz, rx, 2, 2, 3, 3), MATH_SHUFFLE(ry, rz, 3, 3, 3, 3), 0, 2, 0, 2));
+    }
+#endif
+
+    for(; i < end; ++i)
+    {
+        const float x = points[i].x, y = points[i].y, z = points[i].z;
+        result[i] = Vector3D((M.n[0][0] * x + M.n[1][0] * y) + (M.n[2][0] * z + M.n[3][0]),
+                             (M.n[0][1] * x + M.n[1][1] * y) + (M.n[2][1] * z + M.n[3][1]),
+                             (M.n[0][2] * x + M.n[1][2] * y) + (M.n[2][2] * z + M.n[3][2]));
+    }
+}
+
+}
+
+void transformPoints(const Matrix4D& M, const float* xs, const float* ys, const float* zs, std::size_t n,
+                     float* outXs, float* outYs, float* outZs, unsigned int threadCount)
+{
+    /* range boundaries at multiples of 8 points keep the SIMD loops of every range aligned */
+    parallelFor(n, threadCount, [&](std::size_t begin, std::size_t end) {
+        detail::transformPointsSoA(M, xs, ys, zs, outXs, outYs, outZs, begin, end);
+    }, 8);
+}
+
+void transformPoints(const Matrix4D& M, const Vector3D* points, std::size_t n, Vector3D* result, unsigned int threadCount)
+{
+    parallelFor(n, threadCount, [&](std::size_t begin, std::size_t end) {
+        detail::transformPointsAoS(M, points, result, begin, end);
+    }, 8);
+}
+
+void transformPoints(const Matrix4D& M, const std::vector<Vector3D>& points, std::vector<Vector3D>& result, unsigned int threadCount)
+{
+    result.resize(points.size());
+    transformPoints(M, points.data(), points.size(), result.data(), threadCount);
+}
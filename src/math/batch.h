@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "matrix4d.h"
+#include "vector3d.h"
+
+/**
+ * @brief Transform points stored as structure of arrays (x, y and z in separate streams) by a matrix. The points are
+ * treated as homogeneous points with w = 1, the resulting w is dropped (no perspective divide).
+ *
+ * @param M Transformation matrix.
+ * @param xs, ys, zs Input coordinate streams with n elements each.
+ * @param n Number of points.
+ * @param outXs, outYs, outZs Output coordinate streams with n elements each (may alias the input streams).
+ * @param threadCount Number of threads the work is split across (1 runs on the calling thread only).
+ */
+void transformPoints(const Matrix4D& M, const float* xs, const float* ys, const float* zs, std::size_t n,
+                     float* outXs, float* outYs, float* outZs, unsigned int threadCount = 1);
+
+/**
+ * @brief Transform an array of points by a matrix (w = 1, the resulting w is dropped).
+ *
+ * @param M Transformation matrix.
+ * @param points Input points.
+ * @param n Number of points.
+ * @param result Output points (may alias the input).
+ * @param threadCount Number of threads the work is split across (1 runs on the calling thread only).
+ */
+void transformPoints(const Matrix4D& M, const Vector3D* points, std::size_t n, Vector3D* result, unsigned int threadCount = 1);
+
+/**
+ * @brief Transform a list of points by a matrix (w = 1, the resulting w is dropped).
+ *
+ * @param M Transformation matrix.
+ * @param points Input points.
+ * @param result Output points, resized to the number of input points (may be the same vector as the input).
+ * @param threadCount Number of threads the work is split across (1 runs on the calling thread only).
+ */
+void transformPoints(const Matrix4D& M, const std::vector<Vector3D>& points, std::vector<Vector3D>& result, unsigned int threadCount = 1);
@@ -0,0 +1,60 @@
+#include "bounds.h"
+
+#include <sstream>
+
+namespace detail
+{
+
+inline const Vector3D& pointAt(const Vector3D* points, std::size_t i, std::size_t stride)
+{
+    return *reinterpret_cast<const Vector3D*>(reinterpret_cast<const unsigned char*>(points) + i * stride);
+}
+
+}
+
+AABB boundingBox(const Vector3D* points, std::size_t n, std::size_t stride)
+{
+    AABB b;
+    for(std::size_t i = 0; i < n; i++)
+    {
+        b = merge(b, detail::pointAt(points, i, stride));
+    }
+    return b;
+}
+
+BoundingSphere boundingSphere(const Vector3D* points, std::size_t n, std::size_t stride)
+{
+    if(n == 0)
+    {
+        return BoundingSphere();
+    }
+
+    Vector3D center = boundingBox(points, n, stride).center();
+
+    float radiusSquared = 0.0f;
+    for(std::size_t i = 0; i < n; i++)
+    {
+        Vector3D d = detail::pointAt(points, i, stride) - center;
+        radiusSquared = std::max(radiusSquared, dot(d, d));
+    }
+
+    return BoundingSphere(center, std::sqrt(radiusSquared));
+}
+
+std::ostream& operator<<(std::ostream& os, const AABB& b) {
+    os << toString(b);
+    return os;
+}
+
+std::ostream& operator<<(std::ostream& os, const BoundingSphere& s) {
+    os << toString(s);
+    return os;
+}
+
+const std::string toString(const AABB& b) {
+    return "min: (" + toString(b.min) + "), max: (" + toString(b.max) + ")";
+}
+
+const std::string toString(const BoundingSphere& s) {
+    return "center: (" + toString(s.center) + "), radius: " + std::to_string(s.radius);
+}
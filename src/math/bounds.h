@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <cfloat>
+#include <cstddef>
+
+#include "matrix4d.h"
+
+/* axis aligned bounding box, a default constructed box is empty (min > max) and grows with merge() */
+struct AABB
+{
+    Vector3D min;
+    Vector3D max;
+
+
+    constexpr AABB(const Vector3D& min = {FLT_MAX, FLT_MAX, FLT_MAX}, const Vector3D& max = {-FLT_MAX, -FLT_MAX, -FLT_MAX})
+        : min(min), max(max)
+    {
+
+    }
+
+    constexpr bool empty() const
+    {
+        return min.x > max.x || min.y > max.y || min.z > max.z;
+    }
+
+    constexpr Vector3D center() const
+    {
+        return (min + max) * 0.5f;
+    }
+
+    /* half size along each axis */
+    constexpr Vector3D extents() const
+    {
+        return (max - min) * 0.5f;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const AABB& b);
+};
+
+struct BoundingSphere
+{
+    Vector3D center;
+    float radius;
+
+
+    constexpr BoundingSphere(const Vector3D& center = {0, 0, 0}, float radius = 0)
+        : center(center), radius(radius)
+    {
+
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const BoundingSphere& s);
+};
+
+/* smallest box containing b and the point p */
+inline AABB merge(const AABB& b, const Vector3D& p)
+{
+    return AABB(Vector3D(std::min(b.min.x, p.x), std::min(b.min.y, p.y), std::min(b.min.z, p.z)),
+                Vector3D(std::max(b.max.x, p.x), std::max(b.max.y, p.y), std::max(b.max.z, p.z)));
+}
+
+/* world space box of the box b transformed by the affine matrix M (Arvo's method, stays axis aligned) */
+inline AABB transform(const Matrix4D& M, const AABB& b)
+{
+    Vector3D c = b.center();
+    Vector3D e = b.extents();
+
+    Vector3D center(M(0,0) * c.x + M(0,1) * c.y + M(0,2) * c.z + M(0,3),
+                    M(1,0) * c.x + M(1,1) * c.y + M(1,2) * c.z + M(1,3),
+                    M(2,0) * c.x + M(2,1) * c.y + M(2,2) * c.z + M(2,3));
+    Vector3D extents(std::abs(M(0,0)) * e.x + std::abs(M(0,1)) * e.y + std::abs(M(0,2)) * e.z,
+                     std::abs(M(1,0)) * e.x + std::abs(M(1,1)) * e.y + std::abs(M(1,2)) * e.z,
+                     std::abs(M(2,0)) * e.x + std::abs(M(2,1)) * e.y + std::abs(M(2,2)) * e.z);
+
+    return AABB(center - extents, center + extents);
+}
+
+/* sphere s transformed by the affine matrix M, the radius is scaled by the largest axis scale of M */
+inline BoundingSphere transform(const Matrix4D& M, const BoundingSphere& s)
+{
+    const Vector3D& c = s.center;
+    Vector3D center(M(0,0) * c.x + M(0,1) * c.y + M(0,2) * c.z + M(0,3),
+                    M(1,0) * c.x + M(1,1) * c.y + M(1,2) * c.z + M(1,3),
+                    M(2,0) * c.x + M(2,1) * c.y + M(2,2) * c.z + M(2,3));
+
+    float sx = M(0,0) * M(0,0) + M(1,0) * M(1,0) + M(2,0) * M(2,0);
+    float sy = M(0,1) * M(0,1) + M(1,1) * M(1,1) + M(2,1) * M(2,1);
+    float sz = M(0,2) * M(0,2) + M(1,2) * M(1,2) + M(2,2) * M(2,2);
+
+    return BoundingSphere(center, s.radius * std::sqrt(std::max(sx, std::max(sy, sz))));
+}
+
+/**
+ * @brief Bounding box of a set of points.
+ *
+ * @param points First point.
+ * @param n Number of points.
+ * @param stride Distance between two points in bytes, allows to pass the position member of an interleaved vertex array.
+ *
+ * @return Bounding box (empty if n is 0).
+ */
+AABB boundingBox(const Vector3D* points, std::size_t n, std::size_t stride = sizeof(Vector3D));
+
+/**
+ * @brief Bounding sphere of a set of points, centered in their bounding box. Not minimal, but at most as large as the
+ * sphere around the box and computed in two passes.
+ *
+ * @param points First point.
+ * @param n Number of points.
+ * @param stride Distance between two points in bytes.
+ *
+ * @return Bounding sphere (radius 0 if n is 0).
+ */
+BoundingSphere boundingSphere(const Vector3D* points, std::size_t n, std::size_t stride = sizeof(Vector3D));
+
+const std::string toString(const AABB& b);
+
+const std::string toString(const BoundingSphere& s);
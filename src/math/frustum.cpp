@@ -0,0 +1,182 @@
+#include "frustum.h"
+
+#include <sstream>
+
+#include "simd.h"
+
+namespace detail
+{
+
+inline Vector4D normalizePlane(const Vector4D& p)
+{
+    float l = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+    return l > 0.0f ? p * (1.0f / l) : p;
+}
+
+inline float distance(const Vector4D& p, float x, float y, float z)
+{
+    return p.x * x + p.y * y + p.z * z + p.w;
+}
+
+/* writes the index of every lane whose bit is set in mask, in ascending order */
+inline std::size_t appendLanes(int mask, std::size_t base, unsigned int* visible, std::size_t count)
+{
+    while(mask)
+    {
+        int lane = 0;
+        while(!(mask & (1 << lane))) lane++;
+        visible[count++] = (unsigned int) (base + lane);
+        mask &= mask - 1;
+    }
+    return count;
+}
+
+}
+
+Frustum frustumFromMatrix(const Matrix4D& M, bool zeroToOne, bool reverseZ)
+{
+    Vector4D row0(M(0,0), M(0,1), M(0,2), M(0,3));
+    Vector4D row1(M(1,0), M(1,1), M(1,2), M(1,3));
+    Vector4D row2(M(2,0), M(2,1), M(2,2), M(2,3));
+    Vector4D row3(M(3,0), M(3,1), M(3,2), M(3,3));
+
+    Frustum f;
+    f.planes[Frustum::Left]   = detail::normalizePlane(row3 + row0);
+    f.planes[Frustum::Right]  = detail::normalizePlane(row3 - row0);
+    f.planes[Frustum::Bottom] = detail::normalizePlane(row3 + row1);
+    f.planes[Frustum::Top]    = detail::normalizePlane(row3 - row1);
+
+    /* lower (z >= -w or z >= 0) and upper (z <= w) end of the depth range, reverse-Z swaps near and far */
+    Vector4D lower = detail::normalizePlane(zeroToOne ? row2 : row3 + row2);
+    Vector4D upper = detail::normalizePlane(row3 - row2);
+    f.planes[Frustum::Near]   = reverseZ ? upper : lower;
+    f.planes[Frustum::Far]    = reverseZ ? lower : upper;
+    return f;
+}
+
+bool intersects(const Frustum& f, const BoundingSphere& s)
+{
+    for(const Vector4D& p : f.planes)
+    {
+        if(detail::distance(p, s.center.x, s.center.y, s.center.z) < -s.radius)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool intersects(const Frustum& f, const AABB& b)
+{
+    Vector3D c = b.center();
+    Vector3D e = b.extents();
+
+    for(const Vector4D& p : f.planes)
+    {
+        /* projected radius of the box onto the plane normal */
+        float r = std::abs(p.x) * e.x + std::abs(p.y) * e.y + std::abs(p.z) * e.z;
+        if(detail::distance(p, c.x, c.y, c.z) < -r)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::size_t cull(const Frustum& f, const float* xs, const float* ys, const float* zs, const float* radii, std::size_t n,
+                 unsigned int* visible)
+{
+    std::size_t count = 0;
+    std::size_t i = 0;
+
+#if defined(MATH_AVX)
+    __m256 px[6], py[6], pz[6], pw[6];
+    for(int k = 0; k < 6; k++)
+    {
+        px[k] = _mm256_set1_ps(f.planes[k].x);
+        py[k] = _mm256_set1_ps(f.planes[k].y);
+        pz[k] = _mm256_set1_ps(f.planes[k].z);
+        pw[k] = _mm256_set1_ps(f.planes[k].w);
+    }
+    const __m256 zero = _mm256_setzero_ps();
+
+    for(; i + 8 <= n; i += 8)
+    {
+        const __m256 x = _mm256_loadu_ps(xs + i);
+        const __m256 y = _mm256_loadu_ps(ys + i);
+        const __m256 z = _mm256_loadu_ps(zs + i);
+        const __m256 negR = _mm256_sub_ps(zero, _mm256_loadu_ps(radii + i));
+
+        __m256 outside = zero;
+        for(int k = 0; k < 6; k++)
+        {
+            __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px[k], x), _mm256_mul_ps(py[k], y)), _mm256_add_ps(_mm256_mul_ps(pz[k], z), pw[k]));
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(d, negR, _CMP_LT_OQ));
+        }
+        count = detail::appendLanes(~_mm256_movemask_ps(outside) & 0xff, i, visible, count);
+    }
+#elif defined(MATH_SSE)
+    __m128 px[6], py[6], pz[6], pw[6];
+    for(int k = 0; k < 6; k++)
+    {
+        px[k] = _mm_set1_ps(f.planes[k].x);
+        py[k] = _mm_set1_ps(f.planes[k].y);
+        pz[k] = _mm_set1_ps(f.planes[k].z);
+        pw[k] = _mm_set1_ps(f.planes[k].w);
+    }
+    const __m128 zero = _mm_setzero_ps();
+
+    for(; i + 4 <= n; i += 4)
+    {
+        const __m128 x = _mm_loadu_ps(xs + i);
+        const __m128 y = _mm_loadu_ps(ys + i);
+        const __m128 z = _mm_loadu_ps(zs + i);
+        const __m128 negR = _mm_sub_ps(zero, _mm_loadu_ps(radii + i));
+
+        __m128 outside = zero;
+        for(int k = 0; k < 6; k++)
+        {
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px[k], x), _mm_mul_ps(py[k], y)), _mm_add_ps(_mm_mul_ps(pz[k], z), pw[k]));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(d, negR));
+        }
+        count = detail::appendLanes(~_mm_movemask_ps(outside) & 0xf, i, visible, count);
+    }
+#endif
+
+    for(; i < n; ++i)
+    {
+        bool outside = false;
+        for(const Vector4D& p : f.planes)
+        {
+            outside |= detail::distance(p, xs[i], ys[i], zs[i]) < -radii[i];
+        }
+        if(!outside)
+        {
+            visible[count++] = (unsigned int) i;
+        }
+    }
+
+    return count;
+}
+
+std::size_t cull(const Frustum& f, const CullSpheres& spheres, std::vector<unsigned int>& visible)
+{
+    visible.resize(spheres.size());
+    std::size_t count = cull(f, spheres.xs.data(), spheres.ys.data(), spheres.zs.data(), spheres.radii.data(), spheres.size(), visible.data());
+    visible.resize(count);
+    return count;
+}
+
+std::ostream& operator<<(std::ostream& os, const Frustum& f) {
+    os << toString(f);
+    return os;
+}
+
+const std::string toString(const Frustum& f) {
+    std::stringstream ss;
+    for(const Vector4D& p : f.planes)
+    {
+        ss << "(" << toString(p) << ")" << std::endl;
+    }
+    return ss.str();
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "bounds.h"
+
+/*
+ * View frustum as six planes (a, b, c, d) with normals pointing inside, a point p is inside a plane if
+ * a*p.x + b*p.y + c*p.z + d >= 0. The planes are normalized, so the same expression is the signed distance.
+ */
+struct Frustum
+{
+    enum ePlane { Left = 0, Right = 1, Bottom = 2, Top = 3, Near = 4, Far = 5 };
+
+    Vector4D planes[6];
+
+    friend std::ostream& operator<<(std::ostream& os, const Frustum& f);
+};
+
+/* bounding spheres as structure of arrays for the vectorized cull pass */
+struct CullSpheres
+{
+    std::vector<float> xs;
+    std::vector<float> ys;
+    std::vector<float> zs;
+    std::vector<float> radii;
+
+    void clear()
+    {
+        xs.clear();
+        ys.clear();
+        zs.clear();
+        radii.clear();
+    }
+
+    /* returns the index of the sphere, which is what cull() reports for visible spheres */
+    unsigned int push(const BoundingSphere& s)
+    {
+        xs.push_back(s.center.x);
+        ys.push_back(s.center.y);
+        zs.push_back(s.center.z);
+        radii.push_back(s.radius);
+        return (unsigned int) radii.size() - 1;
+    }
+
+    std::size_t size() const
+    {
+        return radii.size();
+    }
+};
+
+/**
+ * @brief Extract the frustum planes from a view projection matrix (Gribb/Hartmann). A plane with a zero normal (e.g.
+ * the far plane of an infinite projection) never culls.
+ *
+ * @param viewProj Projection matrix times view matrix, e.g. cameraViewProjection(cam).
+ * @param zeroToOne Clip space depth range is 0 <= z <= w (glClipControl) instead of -w <= z <= w.
+ * @param reverseZ The projection maps the near plane to the upper end of the depth range (perspectiveReverseZ()).
+ *
+ * @return World space frustum.
+ */
+Frustum frustumFromMatrix(const Matrix4D& viewProj, bool zeroToOne = false, bool reverseZ = false);
+
+/* conservative tests: false only if the volume is completely outside of one plane */
+bool intersects(const Frustum& f, const BoundingSphere& s);
+
+bool intersects(const Frustum& f, const AABB& b);
+
+/**
+ * @brief Test all spheres against the frustum (4 or 8 at a time depending on the SIMD path) and write the indices of
+ * the ones that are not completely outside.
+ *
+ * @param f Frustum.
+ * @param xs, ys, zs, radii Sphere centers and radii with n elements each.
+ * @param n Number of spheres.
+ * @param visible Output, at least n elements.
+ *
+ * @return Number of visible spheres written to visible (the remaining n - count are culled).
+ */
+std::size_t cull(const Frustum& f, const float* xs, const float* ys, const float* zs, const float* radii, std::size_t n,
+                 unsigned int* visible);
+
+/**
+ * @brief Test all spheres of a set against the frustum.
+ *
+ * @param f Frustum.
+ * @param spheres Sphere set.
+ * @param visible Output, resized to the number of visible spheres and filled with their indices in ascending order.
+ *
+ * @return Number of visible spheres.
+ */
+std::size_t cull(const Frustum& f, const CullSpheres& spheres, std::vector<unsigned int>& visible);
+
+const std::string toString(const Frustum& f);
@@ -2,43 +2,503 @@
 
 #include "matrix3d.h"
 #include "vector4d.h"
+#include "simd.h"
 
 
-struct Matrix4D
+/* column-major storage (n[column][row]), 16-byte aligned so each column can be loaded as one SIMD register */
+struct alignas(16) Matrix4D
 {
     float n[4][4];
 
-    Matrix4D();
-    Matrix4D(float n00, float n01, float n02, float n03,
-             float n10, float n11, float n12, float n13,
-             float n20, float n21, float n22, float n23,
-             float n30, float n31, float n32, float n33);
-
-    Matrix4D(const Vector4D& a, const Vector4D& b, const Vector4D& c, const Vector4D& d);
-    Matrix4D(const Matrix3D& M);
-
-    static Matrix4D identity();
-    static Matrix4D scale(float sx, float sy, float sz);
-    static Matrix4D rotationX(float r);
-    static Matrix4D rotationY(float r);
-    static Matrix4D rotationZ(float r);
-    static Matrix4D rotation(float r, const Vector3D& a);
-    static Matrix4D translation(const Vector3D& v);
-    static Matrix4D perspective(float fov, float aspect, float nearPlane, float farPlane);
-    static Matrix4D ortho(float left, float bottom, float right, float top, float nearPlane, float farPlane);
-
-    float& operator ()(int i, int j);
-    const float& operator ()(int i, int j) const;
-    Vector4D& operator [](int j);
-    const Vector4D& operator [](int j) const;
-    const float* ptr() const;
+    constexpr Matrix4D()
+        : n{}
+    {
+
+    }
+
+    constexpr Matrix4D(float n00, float n01, float n02, float n03,
+                       float n10, float n11, float n12, float n13,
+                       float n20, float n21, float n22, float n23,
+                       float n30, float n31, float n32, float n33)
+        : n{{n00, n10, n20, n30},
+            {n01, n11, n21, n31},
+            {n02, n12, n22, n32},
+            {n03, n13, n23, n33}}
+    {
+
+    }
+
+    /* a, b, c and d are the columns of the matrix */
+    constexpr Matrix4D(const Vector4D& a, const Vector4D& b, const Vector4D& c, const Vector4D& d)
+        : n{{a.x, a.y, a.z, a.w},
+            {b.x, b.y, b.z, b.w},
+            {c.x, c.y, c.z, c.w},
+            {d.x, d.y, d.z, d.w}}
+    {
+
+    }
+
+    constexpr Matrix4D(const Matrix3D& M)
+        : n{{M.n[0][0], M.n[0][1], M.n[0][2], 0},
+            {M.n[1][0], M.n[1][1], M.n[1][2], 0},
+            {M.n[2][0], M.n[2][1], M.n[2][2], 0},
+            {0,         0,         0,         1}}
+    {
+
+    }
+
+    static constexpr Matrix4D identity()
+    {
+        return Matrix4D(1, 0, 0, 0,
+                        0, 1, 0, 0,
+                        0, 0, 1, 0,
+                        0, 0, 0, 1);
+    }
+
+    static constexpr Matrix4D scale(float sx, float sy, float sz)
+    {
+        return Matrix4D(Matrix3D::scale(sx, sy, sz));
+    }
+
+    static Matrix4D rotationX(float r)
+    {
+        return Matrix4D(Matrix3D::rotationX(r));
+    }
+
+    static Matrix4D rotationY(float r)
+    {
+        return Matrix4D(Matrix3D::rotationY(r));
+    }
+
+    static Matrix4D rotationZ(float r)
+    {
+        return Matrix4D(Matrix3D::rotationZ(r));
+    }
+
+    static Matrix4D rotation(float r, const Vector3D& a)
+    {
+        return Matrix4D(Matrix3D::rotation(r, a));
+    }
+
+    static constexpr Matrix4D translation(const Vector3D& v)
+    {
+        return Matrix4D(1, 0, 0, v.x,
+                        0, 1, 0, v.y,
+                        0, 0, 1, v.z,
+                        0, 0, 0,  1  );
+    }
+
+    static Matrix4D perspective(float fov, float aspect, float nearPlane, float farPlane)
+    {
+        float f = 1.0f / std::tan(0.5 * fov);
+        float c1 = -(farPlane + nearPlane) / (farPlane - nearPlane);
+        float c2 = -(2.0 * farPlane * nearPlane) / (farPlane - nearPlane);
+
+        return Matrix4D(f/aspect,   0,  0,  0,
+                        0,          f,  0,  0,
+                        0,          0,  c1, c2,
+                        0,          0,  -1,  0);
+    }
+
+    /* reverse-Z projection with an infinite far plane, depth is 1 at the near plane and falls towards 0 at infinity.
+     * zeroToOne targets the [0, 1] clip depth range of glClipControl, otherwise the OpenGL range [-1, 1] is used, which
+     * keeps the infinite far plane but only half of the depth precision */
+    static Matrix4D perspectiveReverseZ(float fov, float aspect, float nearPlane, bool zeroToOne = true)
+    {
+        float f = 1.0f / std::tan(0.5 * fov);
+        float c1 = zeroToOne ? 0.0f : 1.0f;
+        float c2 = zeroToOne ? nearPlane : 2.0f * nearPlane;
+
+        return Matrix4D(f/aspect,   0,  0,  0,
+                        0,          f,  0,  0,
+                        0,          0,  c1, c2,
+                        0,          0,  -1,  0);
+    }
+
+    static constexpr Matrix4D ortho(float left, float bottom, float right, float top, float near, float far)
+    {
+        return Matrix4D(
+                    2.0f / (right - left),  0.0f,                   0.0f,                   -(right+left)/(right-left),
+                    0.0f,                   2.0f / (top - bottom),  0.0f,                   -(top+bottom)/(top-bottom),
+                    0.0f,                   0.0f,                   -2.0f / (far - near),   -(far+near)/(far-near),
+                    0.0f,                   0.0f,                   0.0f,                   1.0f
+                    );
+    }
+
+    constexpr float& operator ()(int i, int j)
+    {
+        assert(i < 4 && j < 4);
+        return n[j][i];
+    }
+
+    constexpr const float& operator ()(int i, int j) const
+    {
+        assert(i < 4 && j < 4);
+        return n[j][i];
+    }
+
+    Vector4D& operator [](int j)
+    {
+        assert(j < 4);
+        return *reinterpret_cast<Vector4D *>(n[j]);
+    }
+
+    const Vector4D& operator [](int j) const
+    {
+        assert(j < 4);
+        return *reinterpret_cast<const Vector4D *>(n[j]);
+    }
+
+    const float* ptr() const
+    {
+        return &(n[0][0]);
+    }
 
     friend std::ostream& operator<<(std::ostream& os, const Matrix4D& M);
 };
 
-Matrix4D operator *(const Matrix4D& A, const Matrix4D& B);
-Vector4D operator *(const Matrix4D& M, const Vector4D& v);
+constexpr Matrix3D::Matrix3D(const Matrix4D& M)
+    : n{{M.n[0][0], M.n[0][1], M.n[0][2]},
+        {M.n[1][0], M.n[1][1], M.n[1][2]},
+        {M.n[2][0], M.n[2][1], M.n[2][2]}}
+{
+
+}
+
+inline Matrix4D operator *(const Matrix4D& A, const Matrix4D& B)
+{
+    Matrix4D R;
+
+    /* column j of the result is the linear combination of the columns of A weighted by column j of B */
+#if defined(MATH_AVX)
+    const __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(A.n[0]));
+    const __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(A.n[1]));
+    const __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(A.n[2]));
+    const __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(A.n[3]));
+
+    /* two result columns per iteration */
+    for(int j = 0; j < 4; j += 2)
+    {
+        const __m256 b = _mm256_loadu_ps(B.n[j]);
+        __m256 r = _mm256_mul_ps(a0, _mm256_permute_ps(b, MATH_SHUFFLE_MASK(0, 0, 0, 0)));
+        r = _mm256_add_ps(r, _mm256_mul_ps(a1, _mm256_permute_ps(b, MATH_SHUFFLE_MASK(1, 1, 1, 1))));
+        r = _mm256_add_ps(r, _mm256_mul_ps(a2, _mm256_permute_ps(b, MATH_SHUFFLE_MASK(2, 2, 2, 2))));
+        r = _mm256_add_ps(r, _mm256_mul_ps(a3, _mm256_permute_ps(b, MATH_SHUFFLE_MASK(3, 3, 3, 3))));
+        _mm256_storeu_ps(R.n[j], r);
+    }
+#elif defined(MATH_SSE)
+    const __m128 a0 = _mm_load_ps(A.n[0]);
+    const __m128 a1 = _mm_load_ps(A.n[1]);
+    const __m128 a2 = _mm_load_ps(A.n[2]);
+    const __m128 a3 = _mm_load_ps(A.n[3]);
+
+    for(int j = 0; j < 4; ++j)
+    {
+        const __m128 b = _mm_load_ps(B.n[j]);
+        __m128 r = _mm_mul_ps(a0, MATH_SWIZZLE(b, 0, 0, 0, 0));
+        r = _mm_add_ps(r, _mm_mul_ps(a1, MATH_SWIZZLE(b, 1, 1, 1, 1)));
+        r = _mm_add_ps(r, _mm_mul_ps(a2, MATH_SWIZZLE(b, 2, 2, 2, 2)));
+        r = _mm_add_ps(r, _mm_mul_ps(a3, MATH_SWIZZLE(b, 3, 3, 3, 3)));
+        _mm_store_ps(R.n[j], r);
+    }
+#else
+    for(int j = 0; j < 4; ++j)
+    {
+        for(int i = 0; i < 4; ++i)
+        {
+            R.n[j][i] = A.n[0][i] * B.n[j][0] + A.n[1][i] * B.n[j][1] + A.n[2][i] * B.n[j][2] + A.n[3][i] * B.n[j][3];
+        }
+    }
+#endif
+
+    return R;
+}
+
+inline Vector4D operator *(const Matrix4D& M, const Vector4D& v)
+{
+#if defined(MATH_SSE)
+    Vector4D r;
+    __m128 c = _mm_mul_ps(_mm_load_ps(M.n[0]), _mm_set1_ps(v.x));
+    c = _mm_add_ps(c, _mm_mul_ps(_mm_load_ps(M.n[1]), _mm_set1_ps(v.y)));
+    c = _mm_add_ps(c, _mm_mul_ps(_mm_load_ps(M.n[2]), _mm_set1_ps(v.z)));
+    c = _mm_add_ps(c, _mm_mul_ps(_mm_load_ps(M.n[3]), _mm_set1_ps(v.w)));
+    _mm_storeu_ps(&r.x, c);
+    return r;
+#else
+    return Vector4D(M.n[0][0] * v.x + M.n[1][0] * v.y + M.n[2][0] * v.z + M.n[3][0] * v.w,
+                    M.n[0][1] * v.x + M.n[1][1] * v.y + M.n[2][1] * v.z + M.n[3][1] * v.w,
+                    M.n[0][2] * v.x + M.n[1][2] * v.y + M.n[2][2] * v.z + M.n[3][2] * v.w,
+                    M.n[0][3] * v.x + M.n[1][3] * v.y + M.n[2][3] * v.z + M.n[3][3] * v.w);
+#endif
+}
+
+#if defined(MATH_SSE)
+namespace detail
+{
+
+/* 2x2 matrices packed as (m00, m01, m10, m11) */
+
+/* A * B */
+inline __m128 mat2Mul(__m128 a, __m128 b)
+{
+    return _mm_add_ps(_mm_mul_ps(a, MATH_SWIZZLE(b, 0, 3, 0, 3)),
+                      _mm_mul_ps(MATH_SWIZZLE(a, 1, 0, 3, 2), MATH_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+/* adj(A) * B */
+inline __m128 mat2AdjMul(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(MATH_SWIZZLE(a, 3, 3, 0, 0), b),
+                      _mm_mul_ps(MATH_SWIZZLE(a, 1, 1, 2, 2), MATH_SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+/* A * adj(B) */
+inline __m128 mat2MulAdj(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(a, MATH_SWIZZLE(b, 3, 0, 3, 0)),
+                      _mm_mul_ps(MATH_SWIZZLE(a, 1, 0, 3, 2), MATH_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+}
+#endif
+
+inline Matrix4D inverse(const Matrix4D& M)
+{
+#if defined(MATH_SSE)
+    /* 2x2 block inverse; inverse(transpose(M)) == transpose(inverse(M)), so the columns can be treated as rows */
+    const __m128 c0 = _mm_load_ps(M.n[0]);
+    const __m128 c1 = _mm_load_ps(M.n[1]);
+    const __m128 c2 = _mm_load_ps(M.n[2]);
+    const __m128 c3 = _mm_load_ps(M.n[3]);
+
+    const __m128 A = _mm_movelh_ps(c0, c1);
+    const __m128 B = _mm_movehl_ps(c1, c0);
+    const __m128 C = _mm_movelh_ps(c2, c3);
+    const __m128 D = _mm_movehl_ps(c3, c2);
+
+    /* determinants of the blocks as (|A|, |B|, |C|, |D|) */
+    const __m128 detSub = _mm_sub_ps(_mm_mul_ps(MATH_SHUFFLE(c0, c2, 0, 2, 0, 2), MATH_SHUFFLE(c1, c3, 1, 3, 1, 3)),
+                                     _mm_mul_ps(MATH_SHUFFLE(c0, c2, 1, 3, 1, 3), MATH_SHUFFLE(c1, c3, 0, 2, 0, 2)));
+    const __m128 detA = MATH_SWIZZLE(detSub, 0, 0, 0, 0);
+    const __m128 detB = MATH_SWIZZLE(detSub, 1, 1, 1, 1);
+    const __m128 detC = MATH_SWIZZLE(detSub, 2, 2, 2, 2);
+    const __m128 detD = MATH_SWIZZLE(detSub, 3, 3, 3, 3);
+
+    const __m128 D_C = detail::mat2AdjMul(D, C);
+    const __m128 A_B = detail::mat2AdjMul(A, B);
+
+    __m128 X = _mm_sub_ps(_mm_mul_ps(detD, A), detail::mat2Mul(B, D_C));
+    __m128 W = _mm_sub_ps(_mm_mul_ps(detA, D), detail::mat2Mul(C, A_B));
+    __m128 Y = _mm_sub_ps(_mm_mul_ps(detB, C), detail::mat2MulAdj(D, A_B));
+    __m128 Z = _mm_sub_ps(_mm_mul_ps(detC, B), detail::mat2MulAdj(A, D_C));
+
+    /* |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C) */
+    __m128 tr = _mm_mul_ps(A_B, MATH_SWIZZLE(D_C, 0, 2, 1, 3));
+    tr = _mm_add_ps(tr, MATH_SWIZZLE(tr, 1, 0, 3, 2));
+    tr = _mm_add_ps(tr, MATH_SWIZZLE(tr, 2, 3, 0, 1));
+    const __m128 detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+
+    const __m128 invDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+    X = _mm_mul_ps(X, invDet);
+    Y = _mm_mul_ps(Y, invDet);
+    Z = _mm_mul_ps(Z, invDet);
+    W = _mm_mul_ps(W, invDet);
+
+    Matrix4D R;
+    _mm_store_ps(R.n[0], MATH_SHUFFLE(X, Y, 3, 1, 3, 1));
+    _mm_store_ps(R.n[1], MATH_SHUFFLE(X, Y, 2, 0, 2, 0));
+    _mm_store_ps(R.n[2], MATH_SHUFFLE(Z, W, 3, 1, 3, 1));
+    _mm_store_ps(R.n[3], MATH_SHUFFLE(Z, W, 2, 0, 2, 0));
+    return R;
+#else
+    const Vector3D& a = reinterpret_cast<const Vector3D&>(M[0]);
+    const Vector3D& b = reinterpret_cast<const Vector3D&>(M[1]);
+    const Vector3D& c = reinterpret_cast<const Vector3D&>(M[2]);
+    const Vector3D& d = reinterpret_cast<const Vector3D&>(M[3]);
+
+    const float& x = M(3,0);
+    const float& y = M(3,1);
+    const float& z = M(3,2);
+    const float& w = M(3,3);
+
+    Vector3D s = cross(a, b);
+    Vector3D t = cross(c, d);
+    Vector3D u = a * y - b * x;
+    Vector3D v = c * w - d * z;
+
+    float invDet = 1.0f / (dot(s, v) + dot(t, u));
+    s *= invDet;
+    t *= invDet;
+    u *= invDet;
+    v *= invDet;
+
+    Vector3D r0 = cross(b, v) + t * y;
+    Vector3D r1 = cross(v, a) - t * x;
+    Vector3D r2 = cross(d, u) + s * w;
+    Vector3D r3 = cross(u, c) - s * z;
+
+    return (Matrix4D(r0.x, r0.y, r0.z, -dot(b, t),
+                     r1.x, r1.y, r1.z,  dot(a, t),
+                     r2.x, r2.y, r2.z, -dot(d, s),
+                     r3.x, r3.y, r3.z,  dot(c, s)));
+#endif
+}
+
+/*
+ * Fast paths for affine matrices, i.e. matrices whose last row is (0, 0, 0, 1). Everything built from translation(),
+ * scale() and the rotation functions (and therefore model and view matrices) is affine, perspective() is not.
+ */
+
+/*
+ * A * B for affine A and B. The columns of B are loaded and broadcast like in operator *, but the last row of B is
+ * (0, 0, 0, 1): the fourth column of A only adds to the translation column and needs no multiplications.
+ */
+inline Matrix4D affineMultiply(const Matrix4D& A, const Matrix4D& B)
+{
+    Matrix4D R;
+
+#if defined(MATH_AVX)
+    const __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(A.n[0]));
+    const __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(A.n[1]));
+    const __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(A.n[2]));
+
+    /* columns 0 and 1, then 2 and 3 where only column 3 gets the translation of A */
+    const __m256 b01 = _mm256_loadu_ps(B.n[0]);
+    __m256 r = _mm256_mul_ps(a0, _mm256_permute_ps(b01, MATH_SHUFFLE_MASK(0, 0, 0, 0)));
+    r = _mm256_add_ps(r, _mm256_mul_ps(a1, _mm256_permute_ps(b01, MATH_SHUFFLE_MASK(1, 1, 1, 1))));
+    r = _mm256_add_ps(r, _mm256_mul_ps(a2, _mm256_permute_ps(b01, MATH_SHUFFLE_MASK(2, 2, 2, 2))));
+    _mm256_storeu_ps(R.n[0], r);
+
+    const __m256 b23 = _mm256_loadu_ps(B.n[2]);
+    r = _mm256_insertf128_ps(_mm256_setzero_ps(), _mm_load_ps(A.n[3]), 1);
+    r = _mm256_add_ps(r, _mm256_mul_ps(a0, _mm256_permute_ps(b23, MATH_SHUFFLE_MASK(0, 0, 0, 0))));
+    r = _mm256_add_ps(r, _mm256_mul_ps(a1, _mm256_permute_ps(b23, MATH_SHUFFLE_MASK(1, 1, 1, 1))));
+    r = _mm256_add_ps(r, _mm256_mul_ps(a2, _mm256_permute_ps(b23, MATH_SHUFFLE_MASK(2, 2, 2, 2))));
+    _mm256_storeu_ps(R.n[2], r);
+#elif defined(MATH_SSE)
+    const __m128 a0 = _mm_load_ps(A.n[0]);
+    const __m128 a1 = _mm_load_ps(A.n[1]);
+    const __m128 a2 = _mm_load_ps(A.n[2]);
+
+    for(int j = 0; j < 3; ++j)
+    {
+        const __m128 b = _mm_load_ps(B.n[j]);
+        __m128 r = _mm_mul_ps(a0, MATH_SWIZZLE(b, 0, 0, 0, 0));
+        r = _mm_add_ps(r, _mm_mul_ps(a1, MATH_SWIZZLE(b, 1, 1, 1, 1)));
+        r = _mm_add_ps(r, _mm_mul_ps(a2, MATH_SWIZZLE(b, 2, 2, 2, 2)));
+        _mm_store_ps(R.n[j], r);
+    }
+
+    const __m128 b = _mm_load_ps(B.n[3]);
+    __m128 t = _mm_add_ps(_mm_load_ps(A.n[3]), _mm_mul_ps(a0, MATH_SWIZZLE(b, 0, 0, 0, 0)));
+    t = _mm_add_ps(t, _mm_mul_ps(a1, MATH_SWIZZLE(b, 1, 1, 1, 1)));
+    t = _mm_add_ps(t, _mm_mul_ps(a2, MATH_SWIZZLE(b, 2, 2, 2, 2)));
+    _mm_store_ps(R.n[3], t);
+#else
+    for(int j = 0; j < 4; ++j)
+    {
+        for(int i = 0; i < 3; ++i)
+        {
+            R.n[j][i] = A.n[0][i] * B.n[j][0] + A.n[1][i] * B.n[j][1] + A.n[2][i] * B.n[j][2];
+        }
+        R.n[j][3] = 0.0f;
+    }
+    R.n[3][0] += A.n[3][0];
+    R.n[3][1] += A.n[3][1];
+    R.n[3][2] += A.n[3][2];
+    R.n[3][3] = 1.0f;
+#endif
+
+    return R;
+}
+
+/* inverse of an affine matrix: inverse of the upper 3x3 block and the negated, back-rotated translation */
+inline Matrix4D affineInverse(const Matrix4D& M)
+{
+#if defined(MATH_SSE)
+    /* the w lanes of the first three columns are 0, so they stay 0 in the cross products */
+    const __m128 a = _mm_load_ps(M.n[0]);
+    const __m128 b = _mm_load_ps(M.n[1]);
+    const __m128 c = _mm_load_ps(M.n[2]);
+
+    /* cross(u, v) = u.yzx * v.zxy - u.zxy * v.yzx, the rows of the inverse 3x3 block over the determinant */
+    __m128 r0 = _mm_sub_ps(_mm_mul_ps(MATH_SWIZZLE(b, 1, 2, 0, 3), MATH_SWIZZLE(c, 2, 0, 1, 3)),
+                           _mm_mul_ps(MATH_SWIZZLE(b, 2, 0, 1, 3), MATH_SWIZZLE(c, 1, 2, 0, 3)));
+    __m128 r1 = _mm_sub_ps(_mm_mul_ps(MATH_SWIZZLE(c, 1, 2, 0, 3), MATH_SWIZZLE(a, 2, 0, 1, 3)),
+                           _mm_mul_ps(MATH_SWIZZLE(c, 2, 0, 1, 3), MATH_SWIZZLE(a, 1, 2, 0, 3)));
+    __m128 r2 = _mm_sub_ps(_mm_mul_ps(MATH_SWIZZLE(a, 1, 2, 0, 3), MATH_SWIZZLE(b, 2, 0, 1, 3)),
+                           _mm_mul_ps(MATH_SWIZZLE(a, 2, 0, 1, 3), MATH_SWIZZLE(b, 1, 2, 0, 3)));
+
+    __m128 det = _mm_mul_ps(r2, c);
+    det = _mm_add_ps(det, MATH_SWIZZLE(det, 1, 0, 3, 2));
+    det = _mm_add_ps(det, MATH_SWIZZLE(det, 2, 3, 0, 1));
+    const __m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+    r0 = _mm_mul_ps(r0, invDet);
+    r1 = _mm_mul_ps(r1, invDet);
+    r2 = _mm_mul_ps(r2, invDet);
+    __m128 r3 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+    const __m128 t = _mm_load_ps(M.n[3]);
+    __m128 u = _mm_mul_ps(r0, MATH_SWIZZLE(t, 0, 0, 0, 0));
+    u = _mm_add_ps(u, _mm_mul_ps(r1, MATH_SWIZZLE(t, 1, 1, 1, 1)));
+    u = _mm_add_ps(u, _mm_mul_ps(r2, MATH_SWIZZLE(t, 2, 2, 2, 2)));
+
+    Matrix4D R;
+    _mm_store_ps(R.n[0], r0);
+    _mm_store_ps(R.n[1], r1);
+    _mm_store_ps(R.n[2], r2);
+    _mm_store_ps(R.n[3], _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), u));
+    return R;
+#else
+    const Vector3D a(M.n[0][0], M.n[0][1], M.n[0][2]);
+    const Vector3D b(M.n[1][0], M.n[1][1], M.n[1][2]);
+    const Vector3D c(M.n[2][0], M.n[2][1], M.n[2][2]);
+    const Vector3D t(M.n[3][0], M.n[3][1], M.n[3][2]);
+
+    /* the rows of the inverse 3x3 block are the cross products of its columns over the determinant */
+    const float invDet = 1.0f / dot(cross(a, b), c);
+    const Vector3D r0 = cross(b, c) * invDet;
+    const Vector3D r1 = cross(c, a) * invDet;
+    const Vector3D r2 = cross(a, b) * invDet;
+
+    return Matrix4D(r0.x, r0.y, r0.z, -dot(r0, t),
+                    r1.x, r1.y, r1.z, -dot(r1, t),
+                    r2.x, r2.y, r2.z, -dot(r2, t),
+                    0.0f, 0.0f, 0.0f, 1.0f);
+#endif
+}
+
+/* inverse of a rigid body transformation (rotation and translation only): transposed rotation, no division */
+constexpr Matrix4D rigidInverse(const Matrix4D& M)
+{
+    const Vector3D x(M.n[0][0], M.n[0][1], M.n[0][2]);
+    const Vector3D y(M.n[1][0], M.n[1][1], M.n[1][2]);
+    const Vector3D z(M.n[2][0], M.n[2][1], M.n[2][2]);
+    const Vector3D t(M.n[3][0], M.n[3][1], M.n[3][2]);
+
+    return Matrix4D(x.x,  x.y,  x.z,  -dot(x, t),
+                    y.x,  y.y,  y.z,  -dot(y, t),
+                    z.x,  z.y,  z.z,  -dot(z, t),
+                    0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+/* inverse transpose of the upper 3x3 block of M, transforms normals under non-uniform scale */
+constexpr Matrix3D normalMatrix(const Matrix4D& M)
+{
+    const Vector3D a(M.n[0][0], M.n[0][1], M.n[0][2]);
+    const Vector3D b(M.n[1][0], M.n[1][1], M.n[1][2]);
+    const Vector3D c(M.n[2][0], M.n[2][1], M.n[2][2]);
+
+    /* the columns of the inverse transpose are the rows of the inverse */
+    const Vector3D r0 = cross(b, c);
+    const Vector3D r1 = cross(c, a);
+    const Vector3D r2 = cross(a, b);
+    const float invDet = 1.0f / dot(r2, c);
 
-Matrix4D inverse(const Matrix4D& M);
+    return Matrix3D(r0.x * invDet, r1.x * invDet, r2.x * invDet,
+                    r0.y * invDet, r1.y * invDet, r2.y * invDet,
+                    r0.z * invDet, r1.z * invDet, r2.z * invDet);
+}
 
 const std::string toString(const Matrix4D& M);
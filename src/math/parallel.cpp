@@ -0,0 +1,166 @@
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace detail
+{
+
+/* ranges of one parallelFor() call, claimed one at a time by the caller and the workers */
+struct ParallelJob
+{
+    const std::function<void(std::size_t, std::size_t)>* function = nullptr;
+    std::size_t n = 0;
+    std::size_t chunk = 0;
+    std::size_t ranges = 0;
+    std::atomic<std::size_t> next{0};
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::size_t done = 0;
+    std::exception_ptr error;
+};
+
+/*
+ * Workers help with the jobs in the queue. A queue entry can outlive its call once the caller finished all ranges
+ * itself, the shared pointer keeps the job alive and a worker finds no range left to claim.
+ */
+struct ParallelPool
+{
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable available;
+    std::deque<std::shared_ptr<ParallelJob>> jobs;
+    bool stop = false;
+
+    ~ParallelPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        available.notify_all();
+        for(std::thread& worker : workers)
+        {
+            worker.join();
+        }
+    }
+};
+
+void runRanges(ParallelJob& job)
+{
+    for(std::size_t range = job.next++; range < job.ranges; range = job.next++)
+    {
+        const std::size_t begin = range * job.chunk;
+        std::exception_ptr error;
+        try
+        {
+            (*job.function)(begin, std::min(begin + job.chunk, job.n));
+        }
+        catch(...)
+        {
+            error = std::current_exception();
+        }
+
+        bool last = false;
+        {
+            std::lock_guard<std::mutex> lock(job.mutex);
+            if(error && !job.error)
+            {
+                job.error = error;
+            }
+            last = ++job.done == job.ranges;
+        }
+        if(last)
+        {
+            job.finished.notify_all();
+        }
+    }
+}
+
+void workerLoop(ParallelPool* pool)
+{
+    for(;;)
+    {
+        std::shared_ptr<ParallelJob> job;
+        {
+            std::unique_lock<std::mutex> lock(pool->mutex);
+            pool->available.wait(lock, [pool] { return pool->stop || !pool->jobs.empty(); });
+            if(pool->stop)
+            {
+                return;
+            }
+            job = std::move(pool->jobs.front());
+            pool->jobs.pop_front();
+        }
+        runRanges(*job);
+    }
+}
+
+/* one worker less than hardware threads, the calling thread is the last one */
+ParallelPool& pool()
+{
+    static ParallelPool pool;
+    static std::once_flag started;
+    std::call_once(started, []
+    {
+        const unsigned int count = std::max(2u, std::thread::hardware_concurrency()) - 1;
+        for(unsigned int i = 0; i < count; i++)
+        {
+            pool.workers.emplace_back(workerLoop, &pool);
+        }
+    });
+    return pool;
+}
+
+}
+
+void parallelFor(std::size_t n, unsigned int threadCount, const std::function<void(std::size_t, std::size_t)>& function,
+                 std::size_t granularity)
+{
+    granularity = std::max(std::size_t(1), granularity);
+    std::size_t chunk = threadCount > 1 ? (n + threadCount - 1) / threadCount : n;
+    chunk = (chunk + granularity - 1) / granularity * granularity;
+
+    if(chunk >= n)
+    {
+        function(std::size_t(0), n);
+        return;
+    }
+
+    auto job = std::make_shared<detail::ParallelJob>();
+    job->function = &function;
+    job->n = n;
+    job->chunk = chunk;
+    job->ranges = (n + chunk - 1) / chunk;
+
+    detail::ParallelPool& pool = detail::pool();
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        const std::size_t helpers = std::min(job->ranges - 1, pool.workers.size());
+        for(std::size_t i = 0; i < helpers; i++)
+        {
+            pool.jobs.push_back(job);
+        }
+    }
+    pool.available.notify_all();
+
+    /* ranges are only claimed by threads that run them, so nested calls from inside a range can't deadlock */
+    detail::runRanges(*job);
+    {
+        std::unique_lock<std::mutex> lock(job->mutex);
+        job->finished.wait(lock, [&job] { return job->done == job->ranges; });
+    }
+
+    if(job->error)
+    {
+        std::rethrow_exception(job->error);
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+/**
+ * @brief Split [0, n) into threadCount ranges and run function(begin, end) on each. The calling thread works on the
+ * ranges together with a pool of worker threads that is started on first use and shared by all callers, so no thread
+ * is created per call. Returns once all ranges are done, the first exception thrown by a range is rethrown then.
+ *
+ * @param n Number of elements.
+ * @param threadCount Number of ranges (1 runs on the calling thread only and never starts the pool).
+ * @param function Called with the bounds of one range, has to be safe to run concurrently on different ranges.
+ * @param granularity Range boundaries are multiples of it (e.g. the SIMD width).
+ *
+ * usage:
+ *
+ *   parallelFor(points.size(), 4, [&](std::size_t begin, std::size_t end)
+ *   {
+ *       for(std::size_t i = begin; i < end; i++) ...
+ *   });
+ */
+void parallelFor(std::size_t n, unsigned int threadCount, const std::function<void(std::size_t, std::size_t)>& function,
+                 std::size_t granularity = 1);
@@ -0,0 +1,12 @@
+#include "quaternion.h"
+
+#include <sstream>
+
+std::ostream& operator<<(std::ostream& os, const Quaternion& q) {
+    os << toString(q);
+    return os;
+}
+
+const std::string toString(const Quaternion& q) {
+    return "x: " +  std::to_string(q.x) + ", y: " + std::to_string(q.y) + ", z: " + std::to_string(q.z) + ", w: " + std::to_string(q.w);
+}
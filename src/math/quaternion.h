@@ -0,0 +1,161 @@
+#pragma once
+
+#include "matrix4d.h"
+
+/* rotation quaternion x*i + y*j + z*k + w, all rotation functions expect unit quaternions */
+struct Quaternion
+{
+    float x, y, z, w;
+
+
+    constexpr Quaternion(float x = 0, float y = 0, float z = 0, float w = 1)
+        : x(x), y(y), z(z), w(w)
+    {
+
+    }
+
+    constexpr Quaternion(const Vector3D& v, float w)
+        : x(v.x), y(v.y), z(v.z), w(w)
+    {
+
+    }
+
+    static constexpr Quaternion identity()
+    {
+        return Quaternion(0, 0, 0, 1);
+    }
+
+    static Quaternion rotationX(float r)
+    {
+        return Quaternion(std::sin(0.5f * r), 0.0f, 0.0f, std::cos(0.5f * r));
+    }
+
+    static Quaternion rotationY(float r)
+    {
+        return Quaternion(0.0f, std::sin(0.5f * r), 0.0f, std::cos(0.5f * r));
+    }
+
+    static Quaternion rotationZ(float r)
+    {
+        return Quaternion(0.0f, 0.0f, std::sin(0.5f * r), std::cos(0.5f * r));
+    }
+
+    /* rotation by r around the normalized axis a */
+    static Quaternion rotation(float r, const Vector3D& a)
+    {
+        return Quaternion(a * std::sin(0.5f * r), std::cos(0.5f * r));
+    }
+
+    constexpr Vector3D vector() const
+    {
+        return Vector3D(x, y, z);
+    }
+
+    constexpr Quaternion operator -() const
+    {
+        return Quaternion(-x, -y, -z, -w);
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const Quaternion& q);
+};
+
+constexpr Quaternion operator +(const Quaternion& a, const Quaternion& b)
+{
+    return Quaternion(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w);
+}
+
+constexpr Quaternion operator *(const Quaternion& q, float s)
+{
+    return Quaternion(q.x * s, q.y * s, q.z * s, q.w * s);
+}
+
+constexpr Quaternion operator *(float s, const Quaternion& q)
+{
+    return Quaternion(q.x * s, q.y * s, q.z * s, q.w * s);
+}
+
+/* rotation b followed by rotation a */
+constexpr Quaternion operator *(const Quaternion& a, const Quaternion& b)
+{
+    return Quaternion(a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+                      a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+                      a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+                      a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z);
+}
+
+/* rotate v by q */
+constexpr Vector3D operator *(const Quaternion& q, const Vector3D& v)
+{
+    Vector3D u = q.vector();
+    Vector3D t = cross(u, v) * 2.0f;
+    return v + t * q.w + cross(u, t);
+}
+
+constexpr float dot(const Quaternion& a, const Quaternion& b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+inline float length(const Quaternion& q)
+{
+    return std::sqrt(dot(q, q));
+}
+
+inline Quaternion normalize(const Quaternion& q)
+{
+    assert(length(q) != 0.0f);
+    return q * (1.0f / length(q));
+}
+
+constexpr Quaternion conjugate(const Quaternion& q)
+{
+    return Quaternion(-q.x, -q.y, -q.z, q.w);
+}
+
+constexpr Quaternion inverse(const Quaternion& q)
+{
+    return conjugate(q) * (1.0f / dot(q, q));
+}
+
+/* normalized linear interpolation along the shorter arc, cheap but not constant angular velocity */
+inline Quaternion nlerp(const Quaternion& a, const Quaternion& b, float t)
+{
+    float sign = dot(a, b) < 0.0f ? -1.0f : 1.0f;
+    return normalize(a * (1.0f - t) + b * (sign * t));
+}
+
+/* spherical linear interpolation along the shorter arc */
+inline Quaternion slerp(const Quaternion& a, const Quaternion& b, float t)
+{
+    float cosTheta = dot(a, b);
+    Quaternion c = cosTheta < 0.0f ? -b : b;
+    cosTheta = std::abs(cosTheta);
+
+    /* nearly parallel, the sine below would be close to zero */
+    if(cosTheta > 0.9995f)
+    {
+        return nlerp(a, c, t);
+    }
+
+    float theta = std::acos(cosTheta);
+    float invSin = 1.0f / std::sin(theta);
+    return a * (std::sin((1.0f - t) * theta) * invSin) + c * (std::sin(t * theta) * invSin);
+}
+
+constexpr Matrix3D toMatrix3D(const Quaternion& q)
+{
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    return Matrix3D(1.0f - 2.0f * (yy + zz),        2.0f * (xy - wz),        2.0f * (xz + wy),
+                           2.0f * (xy + wz), 1.0f - 2.0f * (xx + zz),        2.0f * (yz - wx),
+                           2.0f * (xz - wy),        2.0f * (yz + wx), 1.0f - 2.0f * (xx + yy));
+}
+
+constexpr Matrix4D toMatrix4D(const Quaternion& q)
+{
+    return Matrix4D(toMatrix3D(q));
+}
+
+const std::string toString(const Quaternion& q);
@@ -0,0 +1,29 @@
+#pragma once
+
+/**
+ * SIMD instruction set selection for the math kernels.
+ *
+ * MATH_SSE is defined when SSE2 is available (always the case on x86-64), MATH_AVX additionally when the compiler
+ * targets AVX (e.g. -mavx or /arch:AVX). Defining MATH_NO_SIMD forces the scalar fallback on every platform.
+ */
+#if !defined(MATH_NO_SIMD)
+#  if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define MATH_SSE 1
+#  endif
+#  if defined(MATH_SSE) && defined(__AVX__)
+#    define MATH_AVX 1
+#  endif
+#endif
+
+#if defined(MATH_AVX)
+#include <immintrin.h>
+#elif defined(MATH_SSE)
+#include <emmintrin.h>
+#endif
+
+#if defined(MATH_SSE)
+/* _MM_SHUFFLE with the lane indices in memory order (x, y, z, w) */
+#define MATH_SHUFFLE_MASK(x, y, z, w) ((x) | ((y) << 2) | ((z) << 4) | ((w) << 6))
+#define MATH_SWIZZLE(v, x, y, z, w) _mm_shuffle_ps((v), (v), MATH_SHUFFLE_MASK(x, y, z, w))
+#define MATH_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps((a), (b), MATH_SHUFFLE_MASK(x, y, z, w))
+#endif
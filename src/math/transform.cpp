@@ -0,0 +1,12 @@
+#include "transform.h"
+
+#include <sstream>
+
+std::ostream& operator<<(std::ostream& os, const Transform& T) {
+    os << toString(T);
+    return os;
+}
+
+const std::string toString(const Transform& T) {
+    return "t: (" + toString(T.t) + ")\nr: (" + toString(T.r) + ")\ns: (" + toString(T.s) + ")";
+}
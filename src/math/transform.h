@@ -0,0 +1,97 @@
+#pragma once
+
+#include "quaternion.h"
+
+/*
+ * Translation, rotation and scale, applied in the order scale, rotate, translate (like T * R * S). Composition is only
+ * exact if the scale of the outer transform is uniform, which holds for the hierarchies we animate.
+ */
+struct Transform
+{
+    Vector3D t;
+    Quaternion r;
+    Vector3D s;
+
+
+    constexpr Transform(const Vector3D& t = {0, 0, 0}, const Quaternion& r = Quaternion::identity(), const Vector3D& s = {1, 1, 1})
+        : t(t), r(r), s(s)
+    {
+
+    }
+
+    static constexpr Transform identity()
+    {
+        return Transform();
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const Transform& T);
+};
+
+static_assert(sizeof(Transform) == 10 * sizeof(float), "Transform is meant to stay compact");
+
+/* transform the point p */
+constexpr Vector3D operator *(const Transform& T, const Vector3D& p)
+{
+    return T.t + T.r * Vector3D(T.s.x * p.x, T.s.y * p.y, T.s.z * p.z);
+}
+
+/* B followed by A */
+constexpr Transform operator *(const Transform& A, const Transform& B)
+{
+    return Transform(A * B.t, A.r * B.r, Vector3D(A.s.x * B.s.x, A.s.y * B.s.y, A.s.z * B.s.z));
+}
+
+/*
+ * The inverse scales after rotating (S^-1 * R^-1 * T^-1), which a Transform can only hold if the scale is uniform (or the
+ * rotation keeps the axes). The translation is always exact, the rotation and scale are not for non-uniform scale, use
+ * toInverseMatrix4D() then.
+ */
+constexpr Transform inverse(const Transform& T)
+{
+    Quaternion r = conjugate(T.r);
+    Vector3D s(1.0f / T.s.x, 1.0f / T.s.y, 1.0f / T.s.z);
+    Vector3D t = r * -T.t;
+
+    return Transform(Vector3D(t.x * s.x, t.y * s.y, t.z * s.z), r, s);
+}
+
+/* linear interpolation of translation and scale, spherical interpolation of the rotation */
+inline Transform interpolate(const Transform& a, const Transform& b, float t)
+{
+    return Transform(a.t + (b.t - a.t) * t, slerp(a.r, b.r, t), a.s + (b.s - a.s) * t);
+}
+
+/* only renormalizes the rotation, accumulated rotations drift away from unit length otherwise */
+inline Transform normalize(const Transform& T)
+{
+    return Transform(T.t, normalize(T.r), T.s);
+}
+
+constexpr Matrix4D toMatrix4D(const Transform& T)
+{
+    Matrix3D R = toMatrix3D(T.r);
+
+    return Matrix4D(R(0,0) * T.s.x, R(0,1) * T.s.y, R(0,2) * T.s.z, T.t.x,
+                    R(1,0) * T.s.x, R(1,1) * T.s.y, R(1,2) * T.s.z, T.t.y,
+                    R(2,0) * T.s.x, R(2,1) * T.s.y, R(2,2) * T.s.z, T.t.z,
+                    0.0f,           0.0f,           0.0f,           1.0f);
+}
+
+/* exact inverse for any (non-zero) scale, the scale is inverted per axis after undoing the rotation */
+constexpr Matrix4D toInverseMatrix4D(const Transform& T)
+{
+    Matrix3D R = toMatrix3D(T.r);
+    Vector3D s(1.0f / T.s.x, 1.0f / T.s.y, 1.0f / T.s.z);
+
+    /* rows of S^-1 * R^T are the columns of R scaled by the inverse scale */
+    Vector3D r0 = Vector3D(R(0,0), R(1,0), R(2,0)) * s.x;
+    Vector3D r1 = Vector3D(R(0,1), R(1,1), R(2,1)) * s.y;
+    Vector3D r2 = Vector3D(R(0,2), R(1,2), R(2,2)) * s.z;
+
+    return Matrix4D(r0.x, r0.y, r0.z, -dot(r0, T.t),
+                    r1.x, r1.y, r1.z, -dot(r1, T.t),
+                    r2.x, r2.y, r2.z, -dot(r2, T.t),
+                    0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+const std::string toString(const Transform& T);
@@ -1,5 +1,8 @@
 #pragma once
 
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include <cassert>
 #include <string>
 
 struct Vector4D;
@@ -9,38 +12,131 @@ struct Vector3D
     float x, y, z;
 
 
-    Vector3D(float x = 0, float y = 0, float z = 0);
-    Vector3D(const Vector4D& v);
+    constexpr Vector3D(float x = 0, float y = 0, float z = 0)
+        : x(x), y(y), z(z)
+    {
 
-    Vector3D& operator *=(float s);
-    Vector3D& operator /=(float s);
+    }
 
-    Vector3D& operator +=(const Vector3D& v);
-    Vector3D& operator -=(const Vector3D& v);
+    /* defined in vector4d.h */
+    constexpr Vector3D(const Vector4D& v);
 
-    Vector3D operator -() const;
+    constexpr Vector3D& operator *=(float s)
+    {
+        x *= s;
+        y *= s;
+        z *= s;
 
-    float& operator [](unsigned int i);
-    const float& operator [](unsigned int i) const;
+        return *this;
+    }
+
+    constexpr Vector3D& operator /=(float s)
+    {
+        assert(s != 0.0f);
+        return *this *= (1.0 / s);
+    }
+
+    constexpr Vector3D& operator +=(const Vector3D& v)
+    {
+        x += v.x;
+        y += v.y;
+        z += v.z;
+
+        return *this;
+    }
+
+    constexpr Vector3D& operator -=(const Vector3D& v)
+    {
+        x -= v.x;
+        y -= v.y;
+        z -= v.z;
+
+        return *this;
+    }
+
+    constexpr Vector3D operator -() const
+    {
+        return Vector3D(-x, -y, -z);
+    }
+
+    float& operator [](unsigned int i)
+    {
+        assert(i < 3);
+        return (&x)[i];
+    }
+
+    const float& operator [](unsigned int i) const
+    {
+        assert(i < 3);
+        return (&x)[i];
+    }
 
     friend std::ostream& operator<<(std::ostream& os, const Vector3D& v);
 };
 
-Vector3D operator *(const Vector3D& v, float s);
-Vector3D operator /(const Vector3D& v, float s);
-Vector3D operator *(float s, const Vector3D& v);
-Vector3D operator /(float s, const Vector3D& v);
+constexpr Vector3D operator *(const Vector3D& v, float s)
+{
+    return Vector3D(v.x * s, v.y * s, v.z * s);
+}
+
+constexpr Vector3D operator /(const Vector3D& v, float s)
+{
+    return Vector3D(v.x / s, v.y / s, v.z / s);
+}
+
+constexpr Vector3D operator *(float s, const Vector3D& v)
+{
+    return Vector3D(v.x * s, v.y * s, v.z * s);
+}
+
+constexpr Vector3D operator /(float s, const Vector3D& v)
+{
+    return Vector3D(v.x / s, v.y / s, v.z / s);
+}
 
-Vector3D operator +(const Vector3D& a, const Vector3D& b);
-Vector3D operator -(const Vector3D& a, const Vector3D& b);
+constexpr Vector3D operator +(const Vector3D& a, const Vector3D& b)
+{
+    return Vector3D(a.x + b.x, a.y + b.y, a.z + b.z);
+}
 
-float length(const Vector3D& v);
-Vector3D normalize(const Vector3D& v);
+constexpr Vector3D operator -(const Vector3D& a, const Vector3D& b)
+{
+    return Vector3D(a.x - b.x, a.y - b.y, a.z - b.z);
+}
 
-float dot(const Vector3D& a, const Vector3D& b);
-Vector3D cross(const Vector3D& a, const Vector3D& b);
+inline float length(const Vector3D& v)
+{
+    return std::sqrt(v.x*v.x + v.y*v.y + v.z*v.z);
+}
+
+inline Vector3D normalize(const Vector3D& v)
+{
+    assert(length(v) != 0.0f);
+    return v / length(v);
+}
 
-Vector3D project(const Vector3D& a, const Vector3D& b);
-Vector3D reject(const Vector3D& a, const Vector3D& b);
+constexpr float dot(const Vector3D& a, const Vector3D& b)
+{
+    return a.x*b.x + a.y*b.y + a.z*b.z;
+}
+
+constexpr Vector3D cross(const Vector3D& a, const Vector3D& b)
+{
+    return Vector3D(
+                a.y * b.z - a.z * b.y,
+                a.z * b.x - a.x * b.z,
+                a.x * b.y - a.y * b.x
+                );
+}
+
+constexpr Vector3D project(const Vector3D& a, const Vector3D& b)
+{
+    return (b * (dot(a, b) / dot(b, b)));
+}
+
+constexpr Vector3D reject(const Vector3D& a, const Vector3D& b)
+{
+    return (a - b * (dot(a, b) / dot(b, b)));
+}
 
 const std::string toString(const Vector3D& v);
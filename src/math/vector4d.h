@@ -7,29 +7,107 @@ struct Vector4D
     float x, y, z, w;
 
 
-    Vector4D(const Vector3D& v, float w = 1.0f);
-    Vector4D(float x = 0, float y = 0, float z = 0, float w = 0);
+    constexpr Vector4D(const Vector3D& v, float w = 1.0f)
+        : x(v.x), y(v.y), z(v.z), w(w)
+    {
 
-    Vector4D& operator *=(float s);
-    Vector4D& operator /=(float s);
+    }
 
-    Vector4D& operator +=(const Vector4D& v);
-    Vector4D& operator -=(const Vector4D& v);
+    constexpr Vector4D(float x = 0, float y = 0, float z = 0, float w = 0)
+        : x(x), y(y), z(z), w(w)
+    {
 
-    Vector4D operator -() const;
+    }
 
-    float& operator [](unsigned int i);
-    const float& operator [](unsigned int i) const;
+    constexpr Vector4D& operator *=(float s)
+    {
+        x *= s;
+        y *= s;
+        z *= s;
+        w *= s;
+        return *this;
+    }
+
+    constexpr Vector4D& operator /=(float s)
+    {
+        assert(s != 0.0f);
+        return *this *= (1.0 / s);
+    }
+
+    constexpr Vector4D& operator +=(const Vector4D& v)
+    {
+        x += v.x;
+        y += v.y;
+        z += v.z;
+        w += v.w;
+
+        return *this;
+    }
+
+    constexpr Vector4D& operator -=(const Vector4D& v)
+    {
+        x -= v.x;
+        y -= v.y;
+        z -= v.z;
+        w -= v.w;
+
+        return *this;
+    }
+
+    constexpr Vector4D operator -() const
+    {
+        return Vector4D(-x, -y, -z, -w);
+    }
+
+    float& operator [](unsigned int i)
+    {
+        assert(i < 4);
+        return ((&x)[i]);
+    }
+
+    const float& operator [](unsigned int i) const
+    {
+        assert(i < 4);
+        return ((&x)[i]);
+    }
 
     friend std::ostream& operator<<(std::ostream& os, const Vector4D& v);
 };
 
-Vector4D operator *(const Vector4D& v, float s);
-Vector4D operator /(const Vector4D& v, float s);
-Vector4D operator *(float s, const Vector4D& v);
-Vector4D operator /(float s, const Vector4D& v);
+constexpr Vector3D::Vector3D(const Vector4D& v)
+    : x(v.x), y(v.y), z(v.z)
+{
 
-Vector4D operator +(const Vector4D& a, const Vector4D& b);
-Vector4D operator -(const Vector4D& a, const Vector4D& b);
+}
+
+constexpr Vector4D operator *(const Vector4D& v, float s)
+{
+    return Vector4D(v.x * s, v.y * s, v.z * s, v.w * s);
+}
+
+constexpr Vector4D operator /(const Vector4D& v, float s)
+{
+    return Vector4D(v.x / s, v.y / s, v.z / s, v.w / s);
+}
+
+constexpr Vector4D operator *(float s, const Vector4D& v)
+{
+    return Vector4D(v.x * s, v.y * s, v.z * s, v.w * s);
+}
+
+constexpr Vector4D operator /(float s, const Vector4D& v)
+{
+    return Vector4D(v.x / s, v.y / s, v.z / s, v.w / s);
+}
+
+constexpr Vector4D operator +(const Vector4D& a, const Vector4D& b)
+{
+    return Vector4D(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w);
+}
+
+constexpr Vector4D operator -(const Vector4D& a, const Vector4D& b)
+{
+    return Vector4D(a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w);
+}
 
 const std::string toString(const Vector4D& v);
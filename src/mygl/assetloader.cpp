@@ -0,0 +1,639 @@
+#include "assetloader.h"
+#include "meshfile.h"
+#include "meshimport.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <stb_image/stb_image.h>
+
+namespace detail
+{
+
+/* one queued piece of work: step() is repeated until it returns true, then finalize() runs on the render thread.
+   cancel() releases the asset if the loader is deleted first */
+struct AssetTask
+{
+    std::function<bool()> step;
+    std::function<void()> finalize;
+    std::function<void()> cancel;
+    GLsync fence = nullptr;
+};
+
+/* GL side of an asset: step() creates and fills the shared objects (buffers, textures, programs) and returns true once
+   complete, it runs on the upload thread if there is one. finalize() creates the objects that are not shared between
+   contexts (VAOs) and always runs on the render thread */
+template<typename T>
+struct Upload
+{
+    std::function<bool(T&)> step;
+    std::function<void(T&)> finalize;
+};
+
+/* at most this many bytes are uploaded per step, so a huge asset cannot stall a frame */
+const std::size_t uploadSliceBytes = std::size_t(4) << 20;
+
+}
+
+struct AssetLoader
+{
+    std::vector<std::thread> workers;
+
+    std::mutex jobMutex;
+    std::condition_variable jobAvailable;
+    std::deque<detail::AssetTask> jobs;
+    bool stop = false;
+
+    /* filled by the workers, consumed by the upload thread or moved to active by assetLoaderUpdate() */
+    std::mutex uploadMutex;
+    std::condition_variable uploadAvailable;
+    std::deque<detail::AssetTask> uploads;
+    std::deque<detail::AssetTask> active;
+
+    /* optional shared context, its thread hands tasks with a fence back through fenced */
+    GLFWwindow* uploadContext = nullptr;
+    std::thread uploadThread;
+    std::mutex fencedMutex;
+    std::deque<detail::AssetTask> fenced;
+
+    std::atomic<unsigned int> pending{0};
+    std::atomic<unsigned int> finished{0};
+};
+
+namespace detail
+{
+
+void release(Mesh& mesh)
+{
+    if(mesh.vao != 0 || mesh.vbo != 0 || mesh.ebo != 0)
+    {
+        meshDelete(mesh);
+    }
+    mesh = Mesh();
+}
+
+void release(Texture& texture)
+{
+    if(texture.id != 0)
+    {
+        textureDelete(texture);
+    }
+    texture = Texture();
+}
+
+void release(ShaderProgram& program)
+{
+    if(program.id != 0)
+    {
+        shaderDelete(program);
+    }
+    program = ShaderProgram();
+}
+
+template<typename T>
+void finish(AssetLoader* loader, AssetSlot<T>& slot, eAssetState state, const std::string& error = "", bool cancelled = false)
+{
+    if(state == AssetFailed)
+    {
+        if(!cancelled)
+        {
+            std::cerr << "[AssetLoader] " << slot.name << ": " << error << std::endl;
+        }
+        slot.error = error;
+    }
+    slot.state.store(state, std::memory_order_release);
+    loader->pending--;
+    loader->finished++;
+}
+
+/* decode() runs on a worker and returns the upload step, which is queued for the main thread */
+template<typename T, typename Decode>
+AssetHandle<T> submit(AssetLoader* loader, const std::string& name, Decode decode)
+{
+    auto slot = std::make_shared<AssetSlot<T>>();
+    slot->name = name;
+    loader->pending++;
+
+    AssetTask job;
+    job.step = [loader, slot, decode]()
+    {
+        Upload<T> upload;
+        try
+        {
+            upload = decode();
+        }
+        catch(const std::exception& e)
+        {
+            finish(loader, *slot, AssetFailed, e.what());
+            return true;
+        }
+
+        /* a failed step finishes the slot, finalize() skips it then */
+        AssetTask task;
+        task.step = [loader, slot, upload]()
+        {
+            try
+            {
+                return upload.step(slot->asset);
+            }
+            catch(const std::exception& e)
+            {
+                release(slot->asset);
+                finish(loader, *slot, AssetFailed, e.what());
+            }
+            return true;
+        };
+        task.finalize = [loader, slot, upload]()
+        {
+            if(slot->state.load(std::memory_order_acquire) == AssetFailed)
+            {
+                return;
+            }
+            try
+            {
+                if(upload.finalize)
+                {
+                    upload.finalize(slot->asset);
+                }
+                finish(loader, *slot, AssetReady);
+            }
+            catch(const std::exception& e)
+            {
+                release(slot->asset);
+                finish(loader, *slot, AssetFailed, e.what());
+            }
+        };
+        task.cancel = [loader, slot]()
+        {
+            if(slot->state.load(std::memory_order_acquire) != AssetFailed)
+            {
+                release(slot->asset);
+                finish(loader, *slot, AssetFailed, "loader deleted before the upload", true);
+            }
+        };
+
+        {
+            std::lock_guard<std::mutex> lock(loader->uploadMutex);
+            loader->uploads.push_back(std::move(task));
+        }
+        loader->uploadAvailable.notify_one();
+        return true;
+    };
+    job.cancel = [loader, slot]()
+    {
+        finish(loader, *slot, AssetFailed, "loader deleted before loading", true);
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(loader->jobMutex);
+        loader->jobs.push_back(std::move(job));
+    }
+    loader->jobAvailable.notify_one();
+
+    return AssetHandle<T>{slot};
+}
+
+void workerLoop(AssetLoader* loader)
+{
+    for(;;)
+    {
+        AssetTask job;
+        {
+            std::unique_lock<std::mutex> lock(loader->jobMutex);
+            loader->jobAvailable.wait(lock, [loader] { return loader->stop || !loader->jobs.empty(); });
+            if(loader->stop)
+            {
+                return;
+            }
+            job = std::move(loader->jobs.front());
+            loader->jobs.pop_front();
+        }
+        job.step();
+    }
+}
+
+/* runs all uploads to completion on the shared context, the render thread finalizes them once their fence signaled */
+void uploadLoop(AssetLoader* loader)
+{
+    glfwMakeContextCurrent(loader->uploadContext);
+
+    for(;;)
+    {
+        AssetTask task;
+        {
+            std::unique_lock<std::mutex> lock(loader->uploadMutex);
+            loader->uploadAvailable.wait(lock, [loader] { return loader->stop || !loader->uploads.empty(); });
+            if(loader->stop)
+            {
+                break;
+            }
+            task = std::move(loader->uploads.front());
+            loader->uploads.pop_front();
+        }
+
+        while(!task.step())
+        {
+        }
+
+        /* the flush submits the fence, otherwise another context could wait for it forever */
+        task.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+
+        std::lock_guard<std::mutex> lock(loader->fencedMutex);
+        loader->fenced.push_back(std::move(task));
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
+
+std::string readText(const std::string& filepath)
+{
+    std::ifstream file(filepath);
+    if(!file.is_open())
+    {
+        throw std::runtime_error("couldn't open file " + filepath);
+    }
+
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+/* touch every page of a mapping, so that the upload on the main thread does not wait for the disk */
+void prefault(const void* data, std::size_t size)
+{
+    const volatile unsigned char* bytes = static_cast<const volatile unsigned char*>(data);
+    for(std::size_t i = 0; i < size; i += 4096)
+    {
+        bytes[i];
+    }
+}
+
+/* upload the next slice of data into a buffer, returns the number of bytes written */
+std::size_t bufferSlice(GLuint buffer, const unsigned char* data, std::size_t offset, std::size_t size)
+{
+    std::size_t slice = std::min(uploadSliceBytes, size - offset);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, GLintptr(offset), GLsizeiptr(slice), data + offset);
+    glCheckError();
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    return slice;
+}
+
+/* CPU side of a mesh, either pointing into a mapped .mesh file or into decoded storage */
+struct MeshData
+{
+    std::shared_ptr<MeshFile> file;
+    std::vector<unsigned char> vertexStorage;
+    std::vector<unsigned char> indexStorage;
+
+    const unsigned char* vertices = nullptr;
+    const unsigned char* indices = nullptr;
+    std::size_t vertexBytes = 0;
+    std::size_t indexBytes = 0;
+
+    VertexLayout layout;
+    unsigned int vertexCount = 0;
+    unsigned int indexCount = 0;
+    GLenum indexType = GL_UNSIGNED_INT;
+    AABB bounds;
+    BoundingSphere sphere;
+};
+
+std::shared_ptr<MeshData> decodeMesh(const std::string& filepath)
+{
+    auto data = std::make_shared<MeshData>();
+
+    if(filepath.size() > 5 && filepath.compare(filepath.size() - 5, 5, ".mesh") == 0)
+    {
+        data->file = std::shared_ptr<MeshFile>(new MeshFile(meshFileOpen(filepath)), [](MeshFile* file)
+        {
+            meshFileClose(*file);
+            delete file;
+        });
+        prefault(data->file->mapped.data, data->file->mapped.size);
+
+        const MeshFileHeader& header = *data->file->header;
+        data->vertices = static_cast<const unsigned char*>(data->file->vertices);
+        data->indices = static_cast<const unsigned char*>(data->file->indices);
+        data->vertexBytes = std::size_t(header.vertexCount) * header.vertexStride;
+        data->indexBytes = std::size_t(header.indexCount) * header.indexSize;
+        data->layout = meshFileLayout(*data->file);
+        data->vertexCount = header.vertexCount;
+        data->indexCount = header.indexCount;
+        data->indexType = header.indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        data->bounds = AABB(Vector3D(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]),
+                            Vector3D(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]));
+        data->sphere = BoundingSphere{Vector3D(header.sphereCenter[0], header.sphereCenter[1], header.sphereCenter[2]), header.sphereRadius};
+        return data;
+    }
+
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    std::vector<Vector3D> normals;
+    meshImport(filepath, vertices, indices, &normals);
+
+    data->layout = normals.empty() ? vertexLayoutCreate({PositionFloat3, ColorFloat4}) : vertexLayoutCreate({PositionFloat3, ColorFloat4, NormalFloat3});
+    data->bounds = boundingBox(&vertices.data()->pos, vertices.size(), sizeof(Vertex));
+    data->sphere = boundingSphere(&vertices.data()->pos, vertices.size(), sizeof(Vertex));
+    data->vertexStorage = vertexLayoutEncode(data->layout, data->bounds, vertices, normals);
+
+    if(vertices.size() <= 65536)
+    {
+        std::vector<uint16_t> indices16(indices.begin(), indices.end());
+        data->indexStorage.resize(indices16.size() * sizeof(uint16_t));
+        std::copy_n(reinterpret_cast<const unsigned char*>(indices16.data()), data->indexStorage.size(), data->indexStorage.data());
+        data->indexType = GL_UNSIGNED_SHORT;
+    }
+    else
+    {
+        data->indexStorage.resize(indices.size() * sizeof(unsigned int));
+        std::copy_n(reinterpret_cast<const unsigned char*>(indices.data()), data->indexStorage.size(), data->indexStorage.data());
+    }
+
+    data->vertices = data->vertexStorage.data();
+    data->indices = data->indexStorage.data();
+    data->vertexBytes = data->vertexStorage.size();
+    data->indexBytes = data->indexStorage.size();
+    data->vertexCount = (unsigned int) vertices.size();
+    data->indexCount = (unsigned int) indices.size();
+    return data;
+}
+
+/* allocate the buffers and upload vertex and index data slice by slice, the VAO is set up by finalize */
+Upload<Mesh> meshUpload(std::shared_ptr<MeshData> data)
+{
+    Upload<Mesh> upload;
+    std::size_t vertexDone = 0, indexDone = 0;
+
+    upload.step = [data, vertexDone, indexDone](Mesh& mesh) mutable
+    {
+        if(mesh.vbo == 0)
+        {
+            glGenBuffers(1, &mesh.vbo);
+            glGenBuffers(1, &mesh.ebo);
+
+            glBindBuffer(GL_COPY_WRITE_BUFFER, mesh.vbo);
+            glBufferData(GL_COPY_WRITE_BUFFER, GLsizeiptr(data->vertexBytes), nullptr, GL_STATIC_DRAW);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, mesh.ebo);
+            glBufferData(GL_COPY_WRITE_BUFFER, GLsizeiptr(data->indexBytes), nullptr, GL_STATIC_DRAW);
+            glCheckError();
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+
+        if(vertexDone < data->vertexBytes)
+        {
+            vertexDone += bufferSlice(mesh.vbo, data->vertices, vertexDone, data->vertexBytes);
+            return false;
+        }
+        if(indexDone < data->indexBytes)
+        {
+            indexDone += bufferSlice(mesh.ebo, data->indices, indexDone, data->indexBytes);
+            return false;
+        }
+
+        /* the last slice is copied, unmap the file or free the decoded data right away, only the metadata finalize
+           needs stays alive with the task */
+        data->file.reset();
+        data->vertexStorage = std::vector<unsigned char>();
+        data->indexStorage = std::vector<unsigned char>();
+        data->vertices = nullptr;
+        data->indices = nullptr;
+        return true;
+    };
+
+    upload.finalize = [data](Mesh& mesh) mutable
+    {
+        glGenVertexArrays(1, &mesh.vao);
+        glBindVertexArray(mesh.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ebo);
+        vertexLayoutSetup(data->layout);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+        mesh.size_vbo = data->vertexCount;
+        mesh.size_ibo = data->indexCount;
+        mesh.index_type = data->indexType;
+        mesh.bounds = data->bounds;
+        mesh.sphere = data->sphere;
+        mesh.dequantization = vertexLayoutDequantization(data->layout, data->bounds);
+    };
+    return upload;
+}
+
+struct ImageData
+{
+    std::unique_ptr<unsigned char, void (*)(void*)> pixels{nullptr, stbi_image_free};
+    int width = 0;
+    int height = 0;
+};
+
+std::shared_ptr<ImageData> decodeImage(const std::string& filepath)
+{
+    auto image = std::make_shared<ImageData>();
+    int channels = 0;
+    image->pixels.reset(stbi_load(filepath.c_str(), &image->width, &image->height, &channels, 4));
+    if(!image->pixels)
+    {
+        throw std::runtime_error(std::string("couldn't decode image: ") + stbi_failure_reason());
+    }
+
+    /* OpenGL expects the bottom row first, stbi_set_flip_vertically_on_load() would be global state shared by all workers */
+    const std::size_t rowBytes = std::size_t(image->width) * 4;
+    unsigned char* pixels = image->pixels.get();
+    for(int y = 0; y < image->height / 2; y++)
+    {
+        std::swap_ranges(pixels + y * rowBytes, pixels + (y + 1) * rowBytes, pixels + (image->height - 1 - y) * rowBytes);
+    }
+    return image;
+}
+
+/* allocate the texture, upload bands of rows and generate the mip levels last */
+Upload<Texture> textureUpload(std::shared_ptr<ImageData> image, bool mipmaps)
+{
+    Upload<Texture> upload;
+    int rowsDone = 0;
+
+    upload.step = [image, mipmaps, rowsDone](Texture& texture) mutable
+    {
+        if(texture.id == 0)
+        {
+            texture = textureCreate(image->width, image->height, nullptr, mipmaps);
+        }
+
+        const std::size_t rowBytes = std::size_t(image->width) * 4;
+        const int rows = std::min(image->height - rowsDone, std::max(1, int(uploadSliceBytes / std::max<std::size_t>(rowBytes, 1))));
+
+        glBindTexture(GL_TEXTURE_2D, texture.id);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, rowsDone, image->width, rows, GL_RGBA, GL_UNSIGNED_BYTE, image->pixels.get() + rowsDone * rowBytes);
+        rowsDone += rows;
+        if(rowsDone == image->height && mipmaps)
+        {
+            glGenerateMipmap(GL_TEXTURE_2D);
+        }
+        glCheckError();
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        return rowsDone == image->height;
+    };
+    return upload;
+}
+
+}
+
+AssetLoader* assetLoaderCreate(unsigned int threads, GLFWwindow* uploadContext)
+{
+    if(threads == 0)
+    {
+        threads = std::max(2u, std::thread::hardware_concurrency()) - 1;
+    }
+
+    AssetLoader* loader = new AssetLoader();
+    for(unsigned int i = 0; i < threads; i++)
+    {
+        loader->workers.emplace_back(detail::workerLoop, loader);
+    }
+
+    if(uploadContext != nullptr)
+    {
+        loader->uploadContext = uploadContext;
+        loader->uploadThread = std::thread(detail::uploadLoop, loader);
+    }
+    return loader;
+}
+
+void assetLoaderDelete(AssetLoader* loader)
+{
+    {
+        std::lock_guard<std::mutex> jobLock(loader->jobMutex);
+        std::lock_guard<std::mutex> uploadLock(loader->uploadMutex);
+        loader->stop = true;
+    }
+    loader->jobAvailable.notify_all();
+    loader->uploadAvailable.notify_all();
+    for(std::thread& worker : loader->workers)
+    {
+        worker.join();
+    }
+    if(loader->uploadThread.joinable())
+    {
+        loader->uploadThread.join();
+    }
+
+    for(detail::AssetTask& task : loader->jobs)
+    {
+        task.cancel();
+    }
+    for(detail::AssetTask& task : loader->active)
+    {
+        task.cancel();
+    }
+    for(detail::AssetTask& task : loader->uploads)
+    {
+        task.cancel();
+    }
+    for(detail::AssetTask& task : loader->fenced)
+    {
+        glDeleteSync(task.fence);
+        task.cancel();
+    }
+    delete loader;
+}
+
+unsigned int assetLoaderUpdate(AssetLoader* loader, double budgetMs)
+{
+    if(loader->uploadContext == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(loader->uploadMutex);
+        std::move(loader->uploads.begin(), loader->uploads.end(), std::back_inserter(loader->active));
+        loader->uploads.clear();
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::chrono::duration<double, std::milli> budget(budgetMs);
+
+    if(loader->uploadContext != nullptr)
+    {
+        /* the upload thread did the heavy part, fences signal in order so the first pending one ends the loop */
+        std::lock_guard<std::mutex> lock(loader->fencedMutex);
+        while(!loader->fenced.empty() && std::chrono::steady_clock::now() - start < budget)
+        {
+            detail::AssetTask& task = loader->fenced.front();
+            GLenum status = glClientWaitSync(task.fence, 0, 0);
+            if(status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            {
+                break;
+            }
+            glDeleteSync(task.fence);
+            task.finalize();
+            loader->fenced.pop_front();
+        }
+        return loader->finished.exchange(0);
+    }
+
+    while(!loader->active.empty())
+    {
+        detail::AssetTask& task = loader->active.front();
+        if(task.step())
+        {
+            task.finalize();
+            loader->active.pop_front();
+        }
+        if(std::chrono::steady_clock::now() - start >= budget)
+        {
+            break;
+        }
+    }
+
+    return loader->finished.exchange(0);
+}
+
+unsigned int assetLoaderPending(const AssetLoader* loader)
+{
+    return loader->pending.load();
+}
+
+AssetHandle<Mesh> assetLoadMesh(AssetLoader* loader, const std::string& filepath)
+{
+    return detail::submit<Mesh>(loader, filepath, [filepath]()
+    {
+        return detail::meshUpload(detail::decodeMesh(filepath));
+    });
+}
+
+AssetHandle<ShaderProgram> assetLoadShader(AssetLoader* loader, const std::string& vertexPath, const std::string& fragmentPath,
+                                           const std::string& vertexHeader)
+{
+    return detail::submit<ShaderProgram>(loader, vertexPath + " + " + fragmentPath, [vertexPath, fragmentPath, vertexHeader]()
+    {
+        std::string vertexSource = detail::readText(vertexPath);
+        std::string fragmentSource = detail::readText(fragmentPath);
+        detail::Upload<ShaderProgram> upload;
+        upload.step = [vertexSource, fragmentSource, vertexHeader](ShaderProgram& program)
+        {
+            program = shaderCreate(vertexSource, fragmentSource, vertexHeader);
+            return true;
+        };
+        return upload;
+    });
+}
+
+AssetHandle<Texture> assetLoadTexture(AssetLoader* loader, const std::string& filepath, bool mipmaps)
+{
+    return detail::submit<Texture>(loader, filepath, [filepath, mipmaps]()
+    {
+        return detail::textureUpload(detail::decodeImage(filepath), mipmaps);
+    });
+}
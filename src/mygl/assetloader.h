@@ -0,0 +1,165 @@
+#pragma once
+
+#include "mesh.h"
+#include "shader.h"
+#include "texture.h"
+
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+enum eAssetState { AssetLoading = 0, AssetReady = 1, AssetFailed = 2 };
+
+namespace detail
+{
+
+/* shared between the handle, the worker decoding the asset and the thread uploading it */
+template<typename T>
+struct AssetSlot
+{
+    std::atomic<int> state{AssetLoading};
+    T asset;
+    std::string name;
+    std::string error;
+};
+
+}
+
+/* pollable result of an asynchronous load, copies of a handle refer to the same asset */
+template<typename T>
+struct AssetHandle
+{
+    std::shared_ptr<detail::AssetSlot<T>> slot;
+};
+
+/* worker threads, job queue, upload queue and the optional upload thread, created by assetLoaderCreate() */
+struct AssetLoader;
+
+/**
+ * @brief Start the worker threads of an asset loader. Workers read and decode files, the GL uploads are done on the
+ * thread of the GL context in assetLoaderUpdate(). If an upload context is given, a dedicated upload thread makes it
+ * current and uploads buffers, textures and shaders there instead. Each finished upload is followed by a fence
+ * (glFenceSync), the render thread only polls the fences in assetLoaderUpdate() and creates the vertex array objects,
+ * which are not shared between contexts.
+ *
+ * @param threads Number of worker threads, 0 uses all hardware threads but one.
+ * @param uploadContext Hidden window sharing objects with the render context (see windowCreateUploadContext()), or
+ * nullptr to upload on the render thread. Must not be current on any thread and outlive the loader.
+ *
+ * @return Asset loader, has to be deleted with assetLoaderDelete().
+ *
+ * usage:
+ *
+ *   AssetLoader* loader = assetLoaderCreate(0, windowCreateUploadContext(window));
+ *   AssetHandle<Mesh> bunny = assetLoadMesh(loader, "assets/bunny.mesh");
+ *   ... every frame
+ *   assetLoaderUpdate(loader, 2.0);
+ *   if(assetReady(bunny)) { draw assetGet(bunny) }
+ */
+AssetLoader* assetLoaderCreate(unsigned int threads = 0, GLFWwindow* uploadContext = nullptr);
+
+/**
+ * @brief Stop the workers and drop all assets that are not ready yet (their handles become AssetFailed and partially
+ * uploaded GL objects are deleted). Ready assets belong to the caller and are not deleted.
+ *
+ * @param loader Asset loader.
+ */
+void assetLoaderDelete(AssetLoader* loader);
+
+/**
+ * @brief Run queued GL uploads until the time budget is used up. Large buffers and images are uploaded in slices, so a
+ * single asset can be spread over several frames. At least one slice is uploaded per call. With an upload context only
+ * the assets whose fence signaled are finished here. Has to be called on the thread of the render context, once per
+ * frame.
+ *
+ * @param loader Asset loader.
+ * @param budgetMs Time budget in milliseconds.
+ *
+ * @return Number of assets that became ready (or failed) in this call.
+ */
+unsigned int assetLoaderUpdate(AssetLoader* loader, double budgetMs);
+
+/**
+ * @brief Number of requested assets that are not ready or failed yet.
+ *
+ * @param loader Asset loader.
+ *
+ * @return Number of pending assets.
+ */
+unsigned int assetLoaderPending(const AssetLoader* loader);
+
+/**
+ * @brief Load a mesh asynchronously, either a .mesh file (mapped and faulted in on a worker, see meshfile.h) or an .obj or
+ * .ply file (parsed on a worker, see meshimport.h).
+ *
+ * @param loader Asset loader.
+ * @param filepath Path of the mesh file.
+ *
+ * @return Handle of the mesh, the mesh has to be deleted with meshDelete() once it is ready and not used anymore.
+ */
+AssetHandle<Mesh> assetLoadMesh(AssetLoader* loader, const std::string& filepath);
+
+/**
+ * @brief Load a shader program asynchronously, the sources are read on a worker and compiled on the upload thread (or the render thread without an upload context).
+ *
+ * @param loader Asset loader.
+ * @param vertexPath Path to vertex shader file.
+ * @param fragmentPath Path to fragment shader file.
+ * @param vertexHeader Source inserted after the #version line of the vertex shader.
+ *
+ * @return Handle of the shader program, the program has to be deleted with shaderDelete() once it is ready and not
+ * used anymore.
+ */
+AssetHandle<ShaderProgram> assetLoadShader(AssetLoader* loader, const std::string& vertexPath, const std::string& fragmentPath,
+                                           const std::string& vertexHeader = "");
+
+/**
+ * @brief Load an image asynchronously into an RGBA8 texture, decoded with stb_image on a worker.
+ *
+ * @param loader Asset loader.
+ * @param filepath Path of the image (any format stb_image supports).
+ * @param mipmaps Generate mip levels after the upload.
+ *
+ * @return Handle of the texture, the texture has to be deleted with textureDelete() once it is ready and not used
+ * anymore.
+ */
+AssetHandle<Texture> assetLoadTexture(AssetLoader* loader, const std::string& filepath, bool mipmaps = true);
+
+template<typename T>
+eAssetState assetState(const AssetHandle<T>& handle)
+{
+    return handle.slot ? eAssetState(handle.slot->state.load(std::memory_order_acquire)) : AssetFailed;
+}
+
+template<typename T>
+bool assetReady(const AssetHandle<T>& handle)
+{
+    return assetState(handle) == AssetReady;
+}
+
+/**
+ * @brief Access a loaded asset.
+ *
+ * @param handle Handle of a ready asset (see assetReady()).
+ *
+ * @return The asset, valid as long as any copy of the handle exists.
+ */
+template<typename T>
+const T& assetGet(const AssetHandle<T>& handle)
+{
+    if(!assetReady(handle))
+    {
+        std::cerr << "[AssetLoader] " << (handle.slot ? handle.slot->name : std::string("empty handle")) << " is not ready" << std::endl;
+        throw std::runtime_error("[AssetLoader] asset is not ready");
+    }
+    return handle.slot->asset;
+}
+
+/* reason of the failure of an AssetFailed handle */
+template<typename T>
+std::string assetError(const AssetHandle<T>& handle)
+{
+    return assetState(handle) == AssetFailed && handle.slot ? handle.slot->error : std::string();
+}
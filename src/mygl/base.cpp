@@ -6,29 +6,38 @@
 
 #include <stb_image/stb_image_write.h>
 
-/**
- * debugging function from Joey de Vries (LearnOpenGL)
- * https://learnopengl.com/In-Practice/Debugging
-**/
-GLenum glCheckError_(const char *file, int line)
+bool depthSetup(bool reverseZ)
 {
-    GLenum errorCode;
-    while ((errorCode = glGetError()) != GL_NO_ERROR)
+    /*
+     * Without glClipControl the reversed depth stays in [-1, 1] and is stored as 0.5 * z + 0.5, so distant depths end
+     * up around 0.5 where a float has no more precision than 24 bit fixed point. That fallback gains no precision over
+     * the default projection, it only keeps the infinite far plane.
+     */
+    bool zeroToOne = reverseZ && GLAD_GL_ARB_clip_control;
+    if(GLAD_GL_ARB_clip_control)
     {
-        std::string error;
-        switch (errorCode)
-        {
-            case GL_INVALID_ENUM:                  error = "INVALID_ENUM"; break;
-            case GL_INVALID_VALUE:                 error = "INVALID_VALUE"; break;
-            case GL_INVALID_OPERATION:             error = "INVALID_OPERATION"; break;
-            case GL_STACK_OVERFLOW:                error = "STACK_OVERFLOW"; break;
-            case GL_STACK_UNDERFLOW:               error = "STACK_UNDERFLOW"; break;
-            case GL_OUT_OF_MEMORY:                 error = "OUT_OF_MEMORY"; break;
-            case GL_INVALID_FRAMEBUFFER_OPERATION: error = "INVALID_FRAMEBUFFER_OPERATION"; break;
-        }
-        std::cerr << error << " | " << file << " (" << line << ")" << std::endl;
+        glClipControl(GL_LOWER_LEFT, zeroToOne ? GL_ZERO_TO_ONE : GL_NEGATIVE_ONE_TO_ONE);
     }
-    return errorCode;
+
+    glClearDepth(reverseZ ? 0.0 : 1.0);
+    glDepthFunc(reverseZ ? GL_GREATER : GL_LESS);
+    glCheckError();
+
+    return zeroToOne;
+}
+
+void fenceWait(GLsync& fence)
+{
+    if(fence == nullptr)
+    {
+        return;
+    }
+
+    while(glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+    {
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
 }
 
 void screenshotToPNG(const std::string &filepath)
@@ -45,8 +54,25 @@ void screenshotToPNG(const std::string &filepath)
     glReadBuffer(GL_FRONT);
     glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
 
-    stbi_flip_vertically_on_write(true);
-    stbi_write_png(filepath.c_str(), width, height, 4, data.data(), width * 4);
+    /* flip by passing the last row and a negative stride, the global stbi flip flag would race with the capture writers */
+    stbi_write_png(filepath.c_str(), width, height, 4, data.data() + 4 * (height - 1) * width, -width * 4);
+}
+
+/* load the GL entry points of the current context */
+static bool glLoad()
+{
+    if(!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress))
+    {
+        return false;
+    }
+
+    /* glad is generated for GL 3.2, so the core 3.3 divisor is only loaded through the ARB extension, fill it in here
+       so the mesh code needs no window system functions */
+    if(!glad_glVertexAttribDivisorARB)
+    {
+        glad_glVertexAttribDivisorARB = reinterpret_cast<PFNGLVERTEXATTRIBDIVISORARBPROC>(glfwGetProcAddress("glVertexAttribDivisor"));
+    }
+    return true;
 }
 
 void glfw_error_callback(int error, const char* description)
@@ -92,7 +118,7 @@ GLFWwindow* windowCreate(const std::string& title, unsigned int width = 1280, un
 
     /*-------------- init glad ----------------*/
     /* load opengl extensions */
-    if(!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress))
+    if(!glLoad())
     {
         std::cerr << "Couldn't initialize GLAD" << std::endl;
         windowDelete(window);
@@ -102,6 +128,102 @@ GLFWwindow* windowCreate(const std::string& title, unsigned int width = 1280, un
     return window;
 }
 
+/* last GLFW error while creating the headless context, the errors are only printed if no API works */
+static std::string sHeadlessError;
+
+void glfw_headless_error_callback(int error, const char* description)
+{
+    sHeadlessError = description;
+}
+
+GLFWwindow* windowCreateHeadless(unsigned int width, unsigned int height)
+{
+    sHeadlessError.clear();
+    glfwSetErrorCallback(glfw_headless_error_callback);
+    if(!glfwInit())
+    {
+        std::cerr << "Couldn't initialize GLFW, without a display build with -DBUILD_HEADLESS=ON (" << sHeadlessError << ")" << std::endl;
+        glfwSetErrorCallback(glfw_error_callback);
+        return nullptr;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    /* errors of the APIs that are not available are expected, only report them if all of them fail */
+    const std::pair<int, const char*> apis[] = {{GLFW_NATIVE_CONTEXT_API, "native"}, {GLFW_EGL_CONTEXT_API, "EGL"}, {GLFW_OSMESA_CONTEXT_API, "OSMesa"}};
+    std::vector<std::string> errors;
+    GLFWwindow* window = nullptr;
+    for(const auto& [api, name] : apis)
+    {
+        sHeadlessError.clear();
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, api);
+        window = glfwCreateWindow(width, height, "headless", nullptr, nullptr);
+        if(window != nullptr)
+        {
+            break;
+        }
+        errors.push_back(std::string(name) + ": " + (sHeadlessError.empty() ? "unknown error" : sHeadlessError));
+    }
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+    glfwSetErrorCallback(glfw_error_callback);
+
+    if(window == nullptr)
+    {
+        std::cerr << "Couldn't create headless GL context" << std::endl;
+        for(const std::string& error : errors)
+        {
+            std::cerr << "  " << error << std::endl;
+        }
+        glfwTerminate();
+        return nullptr;
+    }
+
+    /* uncapped, the frame rate is what is measured */
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    if(!glLoad())
+    {
+        std::cerr << "Couldn't initialize GLAD" << std::endl;
+        windowDelete(window);
+        return nullptr;
+    }
+
+    return window;
+}
+
+GLFWwindow* windowCreateUploadContext(GLFWwindow* window)
+{
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    GLFWwindow* context = glfwCreateWindow(1, 1, "upload context", nullptr, window);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+    if(context == nullptr)
+    {
+        std::cerr << "Couldn't create shared upload context" << std::endl;
+    }
+    return context;
+}
+
+void windowDeleteUploadContext(GLFWwindow* context)
+{
+    glfwDestroyWindow(context);
+}
 
 void windowDelete(GLFWwindow *window)
 {
@@ -36,7 +36,69 @@ GLFWwindow* windowCreate(const std::string &title, unsigned int width, unsigned
 void windowDelete(GLFWwindow* window);
 
 /**
- * @brief Save current viewport as PNG image.
+ * @brief Create a hidden window and its OpenGL context for rendering into a framebuffer object without showing
+ * anything, vsync is off. Tries the native context API, EGL and OSMesa in this order. On machines without a display,
+ * glfw has to be built with GLFW_USE_OSMESA (see the BUILD_HEADLESS option), then every context is an OSMesa context
+ * rendered by Mesa on the CPU.
+ *
+ * @param width Width of the default framebuffer.
+ * @param height Height of the default framebuffer.
+ *
+ * @return Hidden window or nullptr if no context could be created, delete it with windowDelete().
+ */
+GLFWwindow* windowCreateHeadless(unsigned int width, unsigned int height);
+
+/**
+ * @brief Create a hidden window whose OpenGL context shares objects (buffers, textures, programs, sync objects) with the
+ * context of a window, for uploads from another thread. Container objects (VAOs, FBOs) are not shared. Has to be called
+ * on the main thread, the context is not made current.
+ *
+ * @param window Window whose context is shared.
+ *
+ * @return Hidden window or nullptr if the context could not be created.
+ *
+ * usage:
+ *
+ *   GLFWwindow* uploadContext = windowCreateUploadContext(window);
+ *   ... on the upload thread
+ *   glfwMakeContextCurrent(uploadContext);
+ */
+GLFWwindow* windowCreateUploadContext(GLFWwindow* window);
+
+/**
+ * @brief Delete a window created by windowCreateUploadContext(). The context must not be current on any thread.
+ *
+ * @param context Hidden upload window.
+ */
+void windowDeleteUploadContext(GLFWwindow* context);
+
+/**
+ * @brief Configure the depth test either for reverse-Z (depth cleared to 0, GL_GREATER) or for the default depth test
+ * (depth cleared to 1, GL_LESS). With GL_ARB_clip_control reverse-Z also switches the clip space depth range to [0, 1],
+ * otherwise it stays [-1, 1]. Only the [0, 1] range with a floating point depth buffer (GL_DEPTH_COMPONENT32F, see
+ * framebufferCreate()) gains precision, the fallback just keeps the infinite far plane working.
+ *
+ * @param reverseZ Enable reverse-Z.
+ *
+ * @return true if the [0, 1] depth range is active (pass it on to cameraSetReverseZ()).
+ *
+ * usage:
+ *
+ *   cameraSetReverseZ(camera, true, depthSetup(true));
+ */
+bool depthSetup(bool reverseZ);
+
+/**
+ * @brief Wait until the GPU passed a fence and delete it, used before the CPU rewrites a buffer region the fence
+ * guards. Does nothing if fence is nullptr, which is reset afterwards.
+ *
+ * @param fence Fence set with glFenceSync() after the last commands that used the region.
+ */
+void fenceWait(GLsync& fence);
+
+/**
+ * @brief Save current viewport as PNG image. Waits for the GPU and encodes on the calling thread, see capture.h for
+ * the asynchronous version.
  *
  * @param filepath Path to output image.
  */
@@ -7,9 +7,9 @@
 namespace detail
 {
 
-Vector3D sphericalCoords(const Camera& cam)
+Vector3D sphericalCoords(const Vector3D& position, const Vector3D& lookAt)
 {
-    Vector3D cartVec = cam.position - cam.lookAt;
+    Vector3D cartVec = position - lookAt;
 
     auto r = length(cartVec);
     auto phi = atan2(cartVec.x, cartVec.z);
@@ -18,49 +18,146 @@ Vector3D sphericalCoords(const Camera& cam)
     return Vector3D(r, phi, theta);
 }
 
+void setPosition(Camera& cam, const Vector3D& position, const Vector3D& lookAt)
+{
+    Vector3D spherCoord = sphericalCoords(position, lookAt);
+    cam.position = position;
+    cam.lookAt = lookAt;
+    cam.radius = spherCoord[0];
+    cam.phi = spherCoord[1];
+    cam.theta = spherCoord[2];
+    cam.dirty |= eCameraDirty::DirtyView;
+}
+
+/* recompute whatever changed since the last access, the combined matrices depend on both parts */
+void update(const Camera& cam)
+{
+    if(cam.dirty == 0)
+    {
+        return;
+    }
+
+    if(cam.dirty & eCameraDirty::DirtyProjection)
+    {
+        cam.projection = cam.reverseZ ? Matrix4D::perspectiveReverseZ(cam.fov, cam.width/cam.height, cam.nearPlane, cam.zeroToOne)
+                                      : Matrix4D::perspective(cam.fov, cam.width/cam.height, cam.nearPlane, cam.farPlane);
+        cam.inverseProjection = inverse(cam.projection);
+    }
+
+    if(cam.dirty & eCameraDirty::DirtyView)
+    {
+        Vector3D front = normalize(cam.lookAt - cam.position);
+        Vector3D right = normalize(cross(front, cam.initUp));
+        Vector3D up = normalize(cross(right, front));
+
+        Matrix4D rotation(
+                 right.x,     right.y,     right.z,     0.0f,
+                 up.x,       up.y,       up.z,       0.0f,
+                -front.x,   -front.y,   -front.z,    0.0f,
+                 0.0f,       0.0f,       0.0f,       1.0f
+                );
+
+        cam.view = affineMultiply(rotation, Matrix4D::translation(-cam.position));
+        cam.inverseView = rigidInverse(cam.view);
+    }
+
+    cam.viewProjection = cam.projection * cam.view;
+    cam.inverseViewProjection = cam.inverseView * cam.inverseProjection;
+    cam.dirty = 0;
+}
+
 }
 
 Camera cameraCreate(float width, float height, float fov, float nearPlane, float farPlane, const Vector3D &initPos, const Vector3D &lookAt, const Vector3D &initUp)
 {
-    return {width, height, fov, nearPlane, farPlane, initPos, lookAt, initUp};
+    Camera cam;
+    cam.width = width;
+    cam.height = height;
+    cam.fov = fov;
+    cam.nearPlane = nearPlane;
+    cam.farPlane = farPlane;
+    cam.initUp = initUp;
+    cam.reverseZ = false;
+    cam.zeroToOne = false;
+    cam.dirty = eCameraDirty::DirtyProjection;
+    detail::setPosition(cam, initPos, lookAt);
+
+    return cam;
 }
 
-Matrix4D cameraProjection(const Camera &cam)
+const Matrix4D& cameraProjection(const Camera &cam)
 {
-    return Matrix4D::perspective(cam.fov, cam.width/cam.height, cam.nearPlane, cam.farPlane);
+    detail::update(cam);
+    return cam.projection;
 }
 
-Matrix4D cameraView(const Camera &cam)
+const Matrix4D& cameraView(const Camera &cam)
 {
-    Vector3D front = normalize(cam.lookAt - cam.position);
-    Vector3D right = normalize(cross(front, cam.initUp));
-    Vector3D up = normalize(cross(right, front));
+    detail::update(cam);
+    return cam.view;
+}
 
-    Matrix4D rotation(
-             right.x,     right.y,     right.z,     0.0f,
-             up.x,       up.y,       up.z,       0.0f,
-            -front.x,   -front.y,   -front.z,    0.0f,
-             0.0f,       0.0f,       0.0f,       1.0f
-            );
+const Matrix4D& cameraViewProjection(const Camera &cam)
+{
+    detail::update(cam);
+    return cam.viewProjection;
+}
 
-    return  rotation * Matrix4D::translation(-cam.position);
-} 
+const Matrix4D& cameraInverseView(const Camera &cam)
+{
+    detail::update(cam);
+    return cam.inverseView;
+}
 
-void cameraUpdateOrbit(Camera& cam, const Vector2D& mouseDiff, float zoom)
+const Matrix4D& cameraInverseProjection(const Camera &cam)
+{
+    detail::update(cam);
+    return cam.inverseProjection;
+}
+
+const Matrix4D& cameraInverseViewProjection(const Camera &cam)
 {
-    Vector3D spherCoord = detail::sphericalCoords(cam);
-    float r = spherCoord[0];
-    float phi = spherCoord[1];
-    float theta = spherCoord[2];
+    detail::update(cam);
+    return cam.inverseViewProjection;
+}
+
+Frustum cameraFrustum(const Camera &cam)
+{
+    return frustumFromMatrix(cameraViewProjection(cam), cam.zeroToOne, cam.reverseZ);
+}
 
-    phi += mouseDiff.x * (M_PI / cam.width);
-    theta += mouseDiff.y * (M_PI / cam.height);
-    r += zoom * r;
+void cameraSetReverseZ(Camera& cam, bool reverseZ, bool zeroToOne)
+{
+    cam.reverseZ = reverseZ;
+    cam.zeroToOne = zeroToOne;
+    cam.dirty |= eCameraDirty::DirtyProjection;
+}
+
+void cameraResize(Camera& cam, float width, float height)
+{
+    cam.width = width;
+    cam.height = height;
+    cam.dirty |= eCameraDirty::DirtyProjection;
+}
+
+void cameraLookAt(Camera& cam, const Vector3D& position, const Vector3D& lookAt)
+{
+    detail::setPosition(cam, position, lookAt);
+}
+
+void cameraUpdateOrbit(Camera& cam, const Vector2D& mouseDiff, float zoom)
+{
+    /* the spherical coordinates are stored, only the way back to cartesian coordinates is needed */
+    cam.phi += mouseDiff.x * (M_PI / cam.width);
+    cam.theta += mouseDiff.y * (M_PI / cam.height);
+    cam.radius += zoom * cam.radius;
 
-    theta = std::clamp<float>(theta, 1e-4, M_PI - 1e-4);
-    r = std::max(r, 1e-4f);
+    cam.theta = std::clamp<float>(cam.theta, 1e-4, M_PI - 1e-4);
+    cam.radius = std::max(cam.radius, 1e-4f);
 
-    Vector3D cartCoord(r * sin(theta) * sin(phi), r * cos(theta), r * sin(theta) * cos(phi));
+    float sinTheta = sin(cam.theta);
+    Vector3D cartCoord(cam.radius * sinTheta * sin(cam.phi), cam.radius * cos(cam.theta), cam.radius * sinTheta * cos(cam.phi));
 
     cam.position = cam.lookAt + cartCoord;
+    cam.dirty |= eCameraDirty::DirtyView;
 }
@@ -3,7 +3,15 @@
 #include <math/vector2d.h>
 #include <math/vector3d.h>
 #include <math/matrix4d.h>
+#include <math/frustum.h>
 
+/* parts of the cached camera state that have to be recomputed */
+enum eCameraDirty { DirtyView = 1, DirtyProjection = 2 };
+
+/*
+ * Camera orbiting around lookAt. The fields are read only, changes go through the camera functions so that the cached
+ * matrices are marked dirty and only recomputed on the next access.
+ */
 struct Camera
 {
     float width;
@@ -14,6 +22,24 @@ struct Camera
     Vector3D position;
     Vector3D lookAt;
     Vector3D initUp;
+
+    /* position relative to lookAt in spherical coordinates (distance, azimuth around y, polar angle from y) */
+    float radius;
+    float phi;
+    float theta;
+
+    /* reverse-Z projection with an infinite far plane (farPlane is ignored), zeroToOne if glClipControl is active */
+    bool reverseZ;
+    bool zeroToOne;
+
+    /* cached matrices, valid unless flagged in dirty (see eCameraDirty) */
+    mutable unsigned int dirty;
+    mutable Matrix4D view;
+    mutable Matrix4D projection;
+    mutable Matrix4D viewProjection;
+    mutable Matrix4D inverseView;
+    mutable Matrix4D inverseProjection;
+    mutable Matrix4D inverseViewProjection;
 };
 
 /**
@@ -33,22 +59,99 @@ struct Camera
 Camera cameraCreate(float width, float height, float fov, float nearPlane, float farPlane, const Vector3D& initPos, const Vector3D& lookAt = {0, 0, 0}, const Vector3D& initUp = {0, 1, 0});
 
 /**
- * @brief Get projection matrix from a camera.
+ * @brief Get projection matrix from a camera, only recalculated if the image size or projection parameters changed.
  *
  * @param cam Camera from which the projection matrix is calculated.
  *
  * @return Projection matrix.
  */
-Matrix4D cameraProjection(const Camera& cam);
+const Matrix4D& cameraProjection(const Camera& cam);
 
 /**
- * @brief Get view matrix from a camera.
+ * @brief Get view matrix from a camera, only recalculated if the camera moved.
  *
  * @param cam Camera from which the view matrix is calculated.
  *
  * @return View matrix.
  */
-Matrix4D cameraView(const Camera& cam);
+const Matrix4D& cameraView(const Camera& cam);
+
+/**
+ * @brief Get the product of projection and view matrix from a camera.
+ *
+ * @param cam Camera from which the matrix is calculated.
+ *
+ * @return Projection matrix times view matrix.
+ */
+const Matrix4D& cameraViewProjection(const Camera& cam);
+
+/**
+ * @brief Get the inverse view matrix (camera to world space) from a camera.
+ *
+ * @param cam Camera from which the matrix is calculated.
+ *
+ * @return Inverse view matrix.
+ */
+const Matrix4D& cameraInverseView(const Camera& cam);
+
+/**
+ * @brief Get the inverse projection matrix (clip to camera space) from a camera.
+ *
+ * @param cam Camera from which the matrix is calculated.
+ *
+ * @return Inverse projection matrix.
+ */
+const Matrix4D& cameraInverseProjection(const Camera& cam);
+
+/**
+ * @brief Get the inverse of projection times view matrix (clip to world space) from a camera.
+ *
+ * @param cam Camera from which the matrix is calculated.
+ *
+ * @return Inverse view projection matrix.
+ */
+const Matrix4D& cameraInverseViewProjection(const Camera& cam);
+
+/**
+ * @brief Get the world space view frustum of a camera for culling.
+ *
+ * @param cam Camera from which the frustum is calculated.
+ *
+ * @return View frustum matching the projection mode of the camera.
+ */
+Frustum cameraFrustum(const Camera& cam);
+
+/**
+ * @brief Switch between the default projection and a reverse-Z projection with an infinite far plane
+ * (Matrix4D::perspectiveReverseZ). The depth test has to be configured to match, see depthSetup().
+ *
+ * @param cam Camera that gets updated.
+ * @param reverseZ Use the reverse-Z projection.
+ * @param zeroToOne The clip space depth range is [0, 1] (glClipControl), otherwise [-1, 1].
+ *
+ * usage:
+ *
+ *   cameraSetReverseZ(camera, true, depthSetup(true));
+ */
+void cameraSetReverseZ(Camera& cam, bool reverseZ, bool zeroToOne);
+
+/**
+ * @brief Change the image size of a camera (e.g. on window resize).
+ *
+ * @param cam Camera that gets updated.
+ * @param width Image width.
+ * @param height Image height.
+ */
+void cameraResize(Camera& cam, float width, float height);
+
+/**
+ * @brief Place a camera at a new position looking at a new point.
+ *
+ * @param cam Camera that gets updated.
+ * @param position New position of the camera.
+ * @param lookAt Point at which the camera is looking at.
+ */
+void cameraLookAt(Camera& cam, const Vector3D& position, const Vector3D& lookAt);
 
 /**
  * @brief Update camera position on the orbit around the look at point using spherical coordinates.
@@ -0,0 +1,332 @@
+#include "capture.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <stb_image/stb_image_write.h>
+
+namespace detail
+{
+
+/* one pixel buffer of the ring, fence is set while its readback is in flight */
+struct CaptureBuffer
+{
+    GLuint pbo = 0;
+    GLsizeiptr size = 0;
+    GLsync fence = nullptr;
+    int width = 0;
+    int height = 0;
+    std::vector<std::string> filepaths;
+};
+
+/* copied out of a mapped buffer, rows top to bottom */
+struct CaptureImage
+{
+    std::vector<std::string> filepaths;
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> rgba;
+};
+
+}
+
+struct FrameCapture
+{
+    /* ring of pixel buffers, the in flight ones are first .. first + inFlight - 1 */
+    std::vector<detail::CaptureBuffer> buffers;
+    unsigned int first = 0;
+    unsigned int inFlight = 0;
+
+    std::string screenshotPath;
+    std::string sequencePrefix;
+    unsigned int sequenceFrame = 0;
+    bool sequenceActive = false;
+
+    std::vector<std::thread> writers;
+    mutable std::mutex imageMutex;
+    std::condition_variable imageAvailable;
+    std::condition_variable imageTaken;
+    std::deque<detail::CaptureImage> images;
+    unsigned int maxQueued = 16;
+    bool stop = false;
+
+    unsigned int frames = 0;
+    unsigned int stalls = 0;
+    std::atomic<unsigned int> written{0};
+    std::atomic<unsigned int> failed{0};
+};
+
+namespace detail
+{
+
+void writerLoop(FrameCapture* capture)
+{
+    for(;;)
+    {
+        CaptureImage image;
+        {
+            std::unique_lock<std::mutex> lock(capture->imageMutex);
+            capture->imageAvailable.wait(lock, [capture] { return capture->stop || !capture->images.empty(); });
+            if(capture->images.empty())
+            {
+                return;
+            }
+            image = std::move(capture->images.front());
+            capture->images.pop_front();
+        }
+        capture->imageTaken.notify_one();
+
+        for(const std::string& filepath : image.filepaths)
+        {
+            if(stbi_write_png(filepath.c_str(), image.width, image.height, 4, image.rgba.data(), image.width * 4))
+            {
+                capture->written++;
+            }
+            else
+            {
+                std::cerr << "[Capture] couldn't write " << filepath << std::endl;
+                capture->failed++;
+            }
+        }
+    }
+}
+
+/* map a buffer whose fence signaled and queue its image, blocks while the writers are maxQueued images behind */
+void captureRead(FrameCapture* capture, CaptureBuffer& buffer)
+{
+    glDeleteSync(buffer.fence);
+    buffer.fence = nullptr;
+
+    CaptureImage image;
+    image.filepaths = std::move(buffer.filepaths);
+    image.width = buffer.width;
+    image.height = buffer.height;
+    image.rgba.resize(std::size_t(buffer.width) * buffer.height * 4);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.pbo);
+    const unsigned char* pixels = (const unsigned char*) glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, buffer.size, GL_MAP_READ_BIT);
+    if(pixels == nullptr)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        std::cerr << "[Capture] couldn't map pixel buffer" << std::endl;
+        capture->failed += (unsigned int) image.filepaths.size();
+        return;
+    }
+
+    /* flip while copying, OpenGL rows are bottom to top */
+    const std::size_t rowBytes = std::size_t(buffer.width) * 4;
+    for(int y = 0; y < buffer.height; y++)
+    {
+        std::memcpy(&image.rgba[(buffer.height - 1 - y) * rowBytes], pixels + y * rowBytes, rowBytes);
+    }
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    {
+        std::unique_lock<std::mutex> lock(capture->imageMutex);
+        if(capture->images.size() >= capture->maxQueued)
+        {
+            capture->stalls++;
+            capture->imageTaken.wait(lock, [capture] { return capture->images.size() < capture->maxQueued; });
+        }
+        capture->images.push_back(std::move(image));
+    }
+    capture->imageAvailable.notify_one();
+}
+
+/* read back the oldest buffer in flight, if wait is false only if its fence already signaled */
+bool captureReadOldest(FrameCapture* capture, bool wait)
+{
+    CaptureBuffer& buffer = capture->buffers[capture->first];
+
+    GLbitfield flags = wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0;
+    GLuint64 timeout = wait ? GLuint64(1000000000) : 0;
+    for(;;)
+    {
+        GLenum status = glClientWaitSync(buffer.fence, flags, timeout);
+        if(status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+        {
+            break;
+        }
+        if(status == GL_WAIT_FAILED)
+        {
+            std::cerr << "[Capture] waiting for readback failed" << std::endl;
+            break;
+        }
+        if(!wait)
+        {
+            return false;
+        }
+    }
+
+    captureRead(capture, buffer);
+    capture->first = (capture->first + 1) % capture->buffers.size();
+    capture->inFlight--;
+    return true;
+}
+
+}
+
+FrameCapture* captureCreate(unsigned int buffers, unsigned int threads, unsigned int maxQueued)
+{
+    if(threads == 0)
+    {
+        threads = std::max(2u, std::thread::hardware_concurrency()) - 1;
+    }
+
+    FrameCapture* capture = new FrameCapture();
+    capture->buffers.resize(std::max(2u, buffers));
+    capture->maxQueued = std::max(1u, maxQueued);
+    for(detail::CaptureBuffer& buffer : capture->buffers)
+    {
+        glGenBuffers(1, &buffer.pbo);
+    }
+    for(unsigned int i = 0; i < threads; i++)
+    {
+        capture->writers.emplace_back(detail::writerLoop, capture);
+    }
+    return capture;
+}
+
+void captureDelete(FrameCapture* capture)
+{
+    while(capture->inFlight > 0)
+    {
+        detail::captureReadOldest(capture, true);
+    }
+    for(detail::CaptureBuffer& buffer : capture->buffers)
+    {
+        glDeleteBuffers(1, &buffer.pbo);
+    }
+
+    /* writers drain the queue before they return */
+    {
+        std::lock_guard<std::mutex> lock(capture->imageMutex);
+        capture->stop = true;
+    }
+    capture->imageAvailable.notify_all();
+    for(std::thread& writer : capture->writers)
+    {
+        writer.join();
+    }
+    delete capture;
+}
+
+void captureScreenshot(FrameCapture* capture, const std::string& filepath)
+{
+    capture->screenshotPath = filepath;
+}
+
+void captureSequenceStart(FrameCapture* capture, const std::string& prefix)
+{
+    capture->sequencePrefix = prefix;
+    capture->sequenceFrame = 0;
+    capture->sequenceActive = true;
+}
+
+void captureSequenceStop(FrameCapture* capture)
+{
+    capture->sequenceActive = false;
+}
+
+bool captureSequenceActive(const FrameCapture* capture)
+{
+    return capture->sequenceActive;
+}
+
+void captureUpdate(FrameCapture* capture)
+{
+    while(capture->inFlight > 0 && detail::captureReadOldest(capture, false))
+    {
+    }
+
+    if(capture->screenshotPath.empty() && !capture->sequenceActive)
+    {
+        return;
+    }
+
+    /* all buffers in flight, waiting for the oldest is better than dropping the frame */
+    if(capture->inFlight == capture->buffers.size())
+    {
+        capture->stalls++;
+        detail::captureReadOldest(capture, true);
+    }
+
+    /* nothing to read while the window is minimized, a screenshot request stays pending */
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    if(viewport[2] <= 0 || viewport[3] <= 0)
+    {
+        return;
+    }
+
+    detail::CaptureBuffer& buffer = capture->buffers[(capture->first + capture->inFlight) % capture->buffers.size()];
+    if(!capture->screenshotPath.empty())
+    {
+        buffer.filepaths.push_back(capture->screenshotPath);
+        capture->screenshotPath.clear();
+    }
+    if(capture->sequenceActive)
+    {
+        char number[16];
+        std::snprintf(number, sizeof(number), "%06u", capture->sequenceFrame++);
+        buffer.filepaths.push_back(capture->sequencePrefix + number + ".png");
+    }
+
+    buffer.width = viewport[2];
+    buffer.height = viewport[3];
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.pbo);
+    GLsizeiptr size = GLsizeiptr(buffer.width) * buffer.height * 4;
+    if(size != buffer.size)
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        buffer.size = size;
+    }
+
+    GLint readFramebuffer = 0;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &readFramebuffer);
+    if(readFramebuffer == 0)
+    {
+        glReadBuffer(GL_BACK);
+    }
+
+    /* with a pack buffer bound glReadPixels only queues the copy, the pointer is an offset into the buffer */
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(viewport[0], viewport[1], buffer.width, buffer.height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glCheckError();
+
+    capture->inFlight++;
+    capture->frames++;
+}
+
+CaptureStats captureStats(const FrameCapture* capture)
+{
+    CaptureStats stats;
+    stats.frames = capture->frames;
+    stats.written = capture->written.load();
+    stats.failed = capture->failed.load();
+    stats.stalls = capture->stalls;
+    {
+        std::lock_guard<std::mutex> lock(capture->imageMutex);
+        stats.queued = (unsigned int) capture->images.size();
+    }
+    return stats;
+}
+
+const std::string toString(const CaptureStats& stats)
+{
+    return std::to_string(stats.frames) + " frames, " + std::to_string(stats.written) + " written, "
+        + std::to_string(stats.failed) + " failed, " + std::to_string(stats.stalls) + " stalls, "
+        + std::to_string(stats.queued) + " queued";
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "base.h"
+
+#include <string>
+
+/* counters of a frame capture, see captureStats() */
+struct CaptureStats
+{
+    unsigned int frames = 0;   /* frames read back from the GPU */
+    unsigned int written = 0;  /* images written to disk */
+    unsigned int failed = 0;   /* images that could not be written */
+    unsigned int stalls = 0;   /* frames that had to wait for a readback or the writers instead of being dropped */
+    unsigned int queued = 0;   /* images waiting for a writer */
+};
+
+/* pixel buffer ring, fences and PNG writer threads, created by captureCreate() */
+struct FrameCapture;
+
+/**
+ * @brief Create an asynchronous frame capture. Frames are read into a ring of pixel buffer objects with glReadPixels,
+ * which returns without waiting for the GPU. A buffer is mapped once its fence signaled, a few frames later, and the
+ * image is encoded as PNG and written on a writer thread.
+ *
+ * @param buffers Number of pixel buffers in flight (2 or more), a frame only waits for the GPU if all are in flight.
+ * @param threads Number of writer threads, 0 uses all hardware threads but one.
+ * @param maxQueued Images waiting for a writer before captureUpdate() blocks until one is written.
+ *
+ * @return Frame capture, has to be deleted with captureDelete().
+ *
+ * usage:
+ *
+ *   FrameCapture* capture = captureCreate();
+ *   captureScreenshot(capture, "screenshot.png");
+ *   ... every frame
+ *   sceneDraw();
+ *   captureUpdate(capture);
+ *   glfwSwapBuffers(window);
+ */
+FrameCapture* captureCreate(unsigned int buffers = 3, unsigned int threads = 0, unsigned int maxQueued = 16);
+
+/**
+ * @brief Read back the frames still in flight, wait until all images are written and stop the writer threads. Has to
+ * be called on the thread of the GL context.
+ *
+ * @param capture Frame capture.
+ */
+void captureDelete(FrameCapture* capture);
+
+/**
+ * @brief Request a screenshot of the next frame passed to captureUpdate(). The file is written a few frames later.
+ *
+ * @param capture Frame capture.
+ * @param filepath Path to output image.
+ */
+void captureScreenshot(FrameCapture* capture, const std::string& filepath);
+
+/**
+ * @brief Start capturing every frame passed to captureUpdate() as numbered PNG images, e.g. capture/frame_000000.png.
+ * No frame is dropped: if the GPU or the writers fall behind, captureUpdate() waits for them.
+ *
+ * @param capture Frame capture.
+ * @param prefix Path and name prefix of the images, the directory has to exist.
+ */
+void captureSequenceStart(FrameCapture* capture, const std::string& prefix);
+
+/**
+ * @brief Stop capturing the image sequence, frames already read back are still written.
+ *
+ * @param capture Frame capture.
+ */
+void captureSequenceStop(FrameCapture* capture);
+
+/* true while an image sequence is captured */
+bool captureSequenceActive(const FrameCapture* capture);
+
+/**
+ * @brief Hand finished readbacks to the writers and read back the current frame if requested. The viewport of the
+ * currently bound read framebuffer is captured, the back buffer for the default framebuffer. Has to be called on the
+ * thread of the GL context, after drawing and before swapping the buffers.
+ *
+ * @param capture Frame capture.
+ */
+void captureUpdate(FrameCapture* capture);
+
+CaptureStats captureStats(const FrameCapture* capture);
+
+const std::string toString(const CaptureStats& stats);
@@ -0,0 +1,171 @@
+#include "dynamicmesh.h"
+
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace detail
+{
+
+/* allocate a buffer for all regions, GL_COPY_WRITE_BUFFER leaves the element buffer binding of the current VAO alone */
+void *streamStorage(GLuint buffer, GLsizeiptr size, eStreamMode mode)
+{
+    void *mapped = nullptr;
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    if(mode == eStreamMode::Persistent)
+    {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags);
+        mapped = glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags);
+    }
+    else
+    {
+        glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    }
+    glCheckError();
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    return mapped;
+}
+
+void streamWrite(GLuint buffer, void *mapped, GLintptr offset, GLsizeiptr regionSize, const void *data, GLsizeiptr size, eStreamMode mode)
+{
+    if(size == 0)
+    {
+        return;
+    }
+
+    if(mode == eStreamMode::Persistent)
+    {
+        std::memcpy(static_cast<unsigned char*>(mapped) + offset, data, size);
+        return;
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    if(mode == eStreamMode::Unsynchronized)
+    {
+        /* the fence of the region guarantees that the GPU is done with it */
+        void *region = glMapBufferRange(GL_COPY_WRITE_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+        std::memcpy(region, data, size);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    }
+    else
+    {
+        /* orphan the old storage, the driver hands out fresh memory while the GPU still reads the old one */
+        glBufferData(GL_COPY_WRITE_BUFFER, regionSize, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, 0, size, data);
+    }
+    glCheckError();
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+}
+
+DynamicMesh dynamicMeshCreate(unsigned int vertexCapacity, unsigned int indexCapacity, eStreamMode mode, unsigned int frames)
+{
+    DynamicMesh mesh;
+    mesh.mode = (mode == eStreamMode::Persistent && !GLAD_GL_ARB_buffer_storage) ? eStreamMode::Unsynchronized : mode;
+    mesh.capacity_vertices = vertexCapacity;
+    mesh.capacity_indices = indexCapacity;
+    mesh.frames = mesh.mode == eStreamMode::Orphaning ? 1 : frames;
+    mesh.fences.resize(mesh.frames, nullptr);
+
+    glGenVertexArrays(1, &mesh.vao);
+    glGenBuffers(1, &mesh.vbo);
+    glGenBuffers(1, &mesh.ebo);
+
+    mesh.mappedVertices = static_cast<Vertex*>(detail::streamStorage(mesh.vbo, GLsizeiptr(vertexCapacity) * mesh.frames * sizeof(Vertex), mesh.mode));
+    mesh.mappedIndices = static_cast<unsigned int*>(detail::streamStorage(mesh.ebo, GLsizeiptr(indexCapacity) * mesh.frames * sizeof(unsigned int), mesh.mode));
+
+    glBindVertexArray(mesh.vao);
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ebo);
+
+        glEnableVertexAttribArray(eDataIdx::Position);
+        glEnableVertexAttribArray(eDataIdx::Color);
+        glVertexAttribPointer(eDataIdx::Position,   3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*) offsetof(Vertex, pos));
+        glVertexAttribPointer(eDataIdx::Color,      4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*) offsetof(Vertex, color));
+        glCheckError();
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    return mesh;
+}
+
+void dynamicMeshUpdate(DynamicMesh& mesh, const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+{
+    if(vertices.size() > mesh.capacity_vertices || indices.size() > mesh.capacity_indices)
+    {
+        std::cerr << "[DynamicMesh] " << vertices.size() << " vertices and " << indices.size() << " indices exceed the capacity of "
+                  << mesh.capacity_vertices << " vertices and " << mesh.capacity_indices << " indices" << std::endl;
+        throw std::runtime_error("[DynamicMesh] capacity exceeded");
+    }
+
+    mesh.frame = (mesh.frame + 1) % mesh.frames;
+    fenceWait(mesh.fences[mesh.frame]);
+
+    const GLsizeiptr vertexRegion = GLsizeiptr(mesh.capacity_vertices) * sizeof(Vertex);
+    const GLsizeiptr indexRegion = GLsizeiptr(mesh.capacity_indices) * sizeof(unsigned int);
+
+    detail::streamWrite(mesh.vbo, mesh.mappedVertices, mesh.frame * vertexRegion, vertexRegion,
+                        vertices.data(), vertices.size() * sizeof(Vertex), mesh.mode);
+    detail::streamWrite(mesh.ebo, mesh.mappedIndices, mesh.frame * indexRegion, indexRegion,
+                        indices.data(), indices.size() * sizeof(unsigned int), mesh.mode);
+
+    mesh.size_vbo = (unsigned int) vertices.size();
+    mesh.size_ibo = (unsigned int) indices.size();
+}
+
+void dynamicMeshDraw(DynamicMesh& mesh, GLenum primitive)
+{
+    if(mesh.size_ibo == 0)
+    {
+        return;
+    }
+
+    /* indices are relative to the region, the base vertex moves them into it */
+    glBindVertexArray(mesh.vao);
+    glDrawElementsBaseVertex(primitive, mesh.size_ibo, GL_UNSIGNED_INT,
+                             (void*) (GLintptr(mesh.frame) * mesh.capacity_indices * sizeof(unsigned int)),
+                             GLint(mesh.frame * mesh.capacity_vertices));
+    glBindVertexArray(0);
+
+    if(mesh.mode != eStreamMode::Orphaning)
+    {
+        if(mesh.fences[mesh.frame] != nullptr)
+        {
+            glDeleteSync(mesh.fences[mesh.frame]);
+        }
+        mesh.fences[mesh.frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
+
+void dynamicMeshDelete(DynamicMesh& mesh)
+{
+    for(GLsync& fence : mesh.fences)
+    {
+        if(fence != nullptr)
+        {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+
+    if(mesh.mode == eStreamMode::Persistent)
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, mesh.vbo);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, mesh.ebo);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    glDeleteBuffers(1, &mesh.vbo);
+    glDeleteBuffers(1, &mesh.ebo);
+    glDeleteVertexArrays(1, &mesh.vao);
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "mesh.h"
+
+#include <vector>
+
+/* how the CPU writes into the streaming buffers, later entries are the fallbacks of earlier ones */
+enum eStreamMode { Persistent = 0, Unsynchronized = 1, Orphaning = 2 };
+
+/*
+ * Mesh whose vertices and indices are rewritten every frame (particles, debug lines, deformable geometry). The buffers
+ * are split into one region per frame in flight, a fence per region keeps the CPU from overwriting data the GPU still
+ * reads, so no buffer is ever reallocated.
+ */
+struct DynamicMesh
+{
+    GLuint vao = 0;
+    GLuint vbo = 0;
+    GLuint ebo = 0;
+
+    eStreamMode mode = eStreamMode::Persistent;
+
+    /* capacity of one region */
+    unsigned int capacity_vertices = 0;
+    unsigned int capacity_indices = 0;
+    unsigned int frames = 0;
+
+    /* region written by the last update and its content */
+    unsigned int frame = 0;
+    unsigned int size_vbo = 0;
+    unsigned int size_ibo = 0;
+
+    /* whole buffers, mapped once for eStreamMode::Persistent */
+    Vertex* mappedVertices = nullptr;
+    unsigned int* mappedIndices = nullptr;
+
+    /* one fence per region, set after the region was last drawn */
+    std::vector<GLsync> fences;
+};
+
+/**
+ * @brief Create the streaming buffers of a dynamic mesh. Persistent mapping needs GL_ARB_buffer_storage, without it
+ * regions are written through glMapBufferRange with GL_MAP_UNSYNCHRONIZED_BIT. Orphaning reallocates the storage with
+ * glBufferData on every update and leaves the synchronization to the driver (a single region is used).
+ *
+ * @param vertexCapacity Maximal number of vertices per update.
+ * @param indexCapacity Maximal number of indices per update.
+ * @param mode Preferred stream mode, falls back to the next mode if unsupported.
+ * @param frames Number of frames in flight the buffers are split into.
+ *
+ * @return Dynamic mesh without content.
+ *
+ * usage:
+ *
+ *   DynamicMesh particles = dynamicMeshCreate(1 << 16, 1 << 16);
+ *   ...
+ *   dynamicMeshUpdate(particles, vertex-data, index-data);
+ *   dynamicMeshDraw(particles, GL_POINTS);
+ */
+DynamicMesh dynamicMeshCreate(unsigned int vertexCapacity, unsigned int indexCapacity, eStreamMode mode = eStreamMode::Persistent, unsigned int frames = 3);
+
+/**
+ * @brief Replace the content of a dynamic mesh. Moves on to the next region and waits for its fence first, which only
+ * blocks if the GPU is more than frames - 1 updates behind.
+ *
+ * @param mesh Dynamic mesh (throws if the data exceeds its capacity).
+ * @param vertices Data for each vertex.
+ * @param indices Indices into vertices.
+ */
+void dynamicMeshUpdate(DynamicMesh& mesh, const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+
+/**
+ * @brief Draw the content of the last update and fence its region.
+ *
+ * @param mesh Dynamic mesh.
+ * @param primitive Primitive type the indices describe.
+ */
+void dynamicMeshDraw(DynamicMesh& mesh, GLenum primitive = GL_TRIANGLES);
+
+/**
+ * @brief Cleanup and delete all OpenGL buffers and fences of a dynamic mesh.
+ *
+ * @param mesh Dynamic mesh to delete.
+ */
+void dynamicMeshDelete(DynamicMesh& mesh);
@@ -0,0 +1,44 @@
+#include "framebuffer.h"
+
+#include <iostream>
+#include <stdexcept>
+
+Framebuffer framebufferCreate(int width, int height, GLenum depthFormat)
+{
+    Framebuffer framebuffer;
+    framebuffer.depthFormat = depthFormat;
+    framebuffer.width = width;
+    framebuffer.height = height;
+
+    glGenRenderbuffers(1, &framebuffer.color);
+    glBindRenderbuffer(GL_RENDERBUFFER, framebuffer.color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &framebuffer.depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, framebuffer.depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, depthFormat, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &framebuffer.id);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.id);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, framebuffer.color);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, framebuffer.depth);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glCheckError();
+
+    if(status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        framebufferDelete(framebuffer);
+        std::cerr << "[Framebuffer] framebuffer " << width << "x" << height << " is not complete (status 0x" << std::hex << status << std::dec << ")" << std::endl;
+        throw std::runtime_error("[Framebuffer] framebuffer is not complete");
+    }
+    return framebuffer;
+}
+
+void framebufferDelete(const Framebuffer& framebuffer)
+{
+    glDeleteFramebuffers(1, &framebuffer.id);
+    glDeleteRenderbuffers(1, &framebuffer.color);
+    glDeleteRenderbuffers(1, &framebuffer.depth);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "base.h"
+
+/* offscreen render target with an RGBA8 color and a depth renderbuffer */
+struct Framebuffer
+{
+    GLuint id = 0;
+    GLuint color = 0;
+    GLuint depth = 0;
+    GLenum depthFormat = GL_DEPTH_COMPONENT24;
+    int width = 0;
+    int height = 0;
+};
+
+/**
+ * @brief Create a complete framebuffer object, e.g. to render without a window. Throws if the framebuffer is not
+ * complete.
+ *
+ * @param width Width in pixels.
+ * @param height Height in pixels.
+ * @param depthFormat Format of the depth renderbuffer. GL_DEPTH_COMPONENT32F together with reverse-Z keeps the depth
+ *                    precision nearly constant over the whole view distance, fixed point depth does not gain from it.
+ *
+ * @return Framebuffer.
+ *
+ * usage:
+ *
+ *   Framebuffer target = framebufferCreate(1280, 720);
+ *   glBindFramebuffer(GL_FRAMEBUFFER, target.id);
+ *   glViewport(0, 0, target.width, target.height);
+ */
+Framebuffer framebufferCreate(int width, int height, GLenum depthFormat = GL_DEPTH_COMPONENT24);
+
+/**
+ * @brief Delete the framebuffer and its renderbuffers. Has to be called for each framebuffer after it is not used
+ * anymore.
+ *
+ * @param framebuffer Framebuffer to delete.
+ */
+void framebufferDelete(const Framebuffer& framebuffer);
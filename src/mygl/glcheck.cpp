@@ -0,0 +1,30 @@
+#include "base.h"
+
+#include <iostream>
+
+/* kept apart from base.cpp, so code that only needs the GL loader (e.g. the offline tools) doesn't pull in GLFW */
+
+/**
+ * debugging function from Joey de Vries (LearnOpenGL)
+ * https://learnopengl.com/In-Practice/Debugging
+**/
+GLenum glCheckError_(const char *file, int line)
+{
+    GLenum errorCode;
+    while ((errorCode = glGetError()) != GL_NO_ERROR)
+    {
+        std::string error;
+        switch (errorCode)
+        {
+            case GL_INVALID_ENUM:                  error = "INVALID_ENUM"; break;
+            case GL_INVALID_VALUE:                 error = "INVALID_VALUE"; break;
+            case GL_INVALID_OPERATION:             error = "INVALID_OPERATION"; break;
+            case GL_STACK_OVERFLOW:                error = "STACK_OVERFLOW"; break;
+            case GL_STACK_UNDERFLOW:               error = "STACK_UNDERFLOW"; break;
+            case GL_OUT_OF_MEMORY:                 error = "OUT_OF_MEMORY"; break;
+            case GL_INVALID_FRAMEBUFFER_OPERATION: error = "INVALID_FRAMEBUFFER_OPERATION"; break;
+        }
+        std::cerr << error << " | " << file << " (" << line << ")" << std::endl;
+    }
+    return errorCode;
+}
@@ -1,8 +1,12 @@
 #include "mesh.h"
 
-Mesh meshCreate(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices)
+namespace detail
+{
+
+Mesh create(const std::vector<Vertex> &vertices, const void *indices, std::size_t indexCount, GLenum indexType)
 {
     GLuint vao = 0, vbo = 0, ebo = 0;
+    const std::size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int);
 
     glGenVertexArrays(1, &vao);
     glGenBuffers(1, &vbo);
@@ -15,7 +19,7 @@ Mesh meshCreate(const std::vector<Vertex> &vertices, const std::vector<unsigned
         glCheckError();
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * indexSize, indices, GL_STATIC_DRAW);
         glCheckError();
 
         glEnableVertexAttribArray(eDataIdx::Position);
@@ -29,48 +33,122 @@ Mesh meshCreate(const std::vector<Vertex> &vertices, const std::vector<unsigned
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-    return Mesh{vao, vbo, ebo, (unsigned int) vertices.size(), (unsigned int) indices.size()};
+    Mesh mesh{vao, vbo, ebo, (unsigned int) vertices.size(), (unsigned int) indexCount, indexType};
+    mesh.bounds = boundingBox(&vertices.data()->pos, vertices.size(), sizeof(Vertex));
+    mesh.sphere = boundingSphere(&vertices.data()->pos, vertices.size(), sizeof(Vertex));
+    return mesh;
+}
+
+}
+
+Mesh meshCreate(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices)
+{
+    return detail::create(vertices, indices.data(), indices.size(), GL_UNSIGNED_INT);
+}
+
+Mesh meshCreate(const std::vector<Vertex> &vertices, const std::vector<uint16_t> &indices)
+{
+    return detail::create(vertices, indices.data(), indices.size(), GL_UNSIGNED_SHORT);
 }
 
 Mesh meshCreate(const std::vector<Vector3D>& positions, const std::vector<unsigned int>& indices, const Vector4D& color) {
+    std::vector<Vertex> vertices(positions.size());
+    for (unsigned i=0; i<vertices.size(); i++) {
+        vertices[i] = {positions[i], color};
+    }
+
+    return detail::create(vertices, indices.data(), indices.size(), GL_UNSIGNED_INT);
+}
+
+Mesh meshCreate(const VertexLayout& layout, const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+                const std::vector<Vector3D>& normals)
+{
     GLuint vao = 0, vbo = 0, ebo = 0;
 
     glGenVertexArrays(1, &vao);
     glGenBuffers(1, &vbo);
     glGenBuffers(1, &ebo);
 
-    std::vector<Vertex> vertices(positions.size());
-    for (unsigned i=0; i<vertices.size(); i++) {
-        vertices[i] = {positions[i], color};
-    }
+    AABB bounds = boundingBox(&vertices.data()->pos, vertices.size(), sizeof(Vertex));
+    std::vector<unsigned char> data = vertexLayoutEncode(layout, bounds, vertices, normals);
 
     glBindVertexArray(vao);
     {
         glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, data.size(), data.data(), GL_STATIC_DRAW);
         glCheckError();
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
         glCheckError();
 
-        glEnableVertexAttribArray(eDataIdx::Position);
-        glEnableVertexAttribArray(eDataIdx::Color);
-        glVertexAttribPointer(eDataIdx::Position,   3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*) offsetof(Vertex, pos));
-        glVertexAttribPointer(eDataIdx::Color,      4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*) offsetof(Vertex, color));
-        glCheckError();
+        vertexLayoutSetup(layout);
     }
 
     glBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-    return Mesh{vao, vbo, ebo, (unsigned int) vertices.size(), (unsigned int) indices.size()};
+    Mesh mesh{vao, vbo, ebo, (unsigned int) vertices.size(), (unsigned int) indices.size()};
+    mesh.bounds = bounds;
+    mesh.sphere = boundingSphere(&vertices.data()->pos, vertices.size(), sizeof(Vertex));
+    mesh.dequantization = vertexLayoutDequantization(layout, bounds);
+    return mesh;
+}
+
+void instanceAttributesSetup(GLuint buffer, GLintptr offset)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    for(unsigned int column = 0; column < 4; column++)
+    {
+        glEnableVertexAttribArray(eDataIdx::InstanceModel + column);
+        glVertexAttribPointer(eDataIdx::InstanceModel + column, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                              (void*) (offset + offsetof(InstanceData, model) + column * sizeof(Vector4D)));
+        glVertexAttribDivisorARB(eDataIdx::InstanceModel + column, 1);
+    }
+    glEnableVertexAttribArray(eDataIdx::InstanceColor);
+    glVertexAttribPointer(eDataIdx::InstanceColor, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*) (offset + offsetof(InstanceData, color)));
+    glVertexAttribDivisorARB(eDataIdx::InstanceColor, 1);
+    glCheckError();
+}
+
+void meshUpdateInstances(Mesh &mesh, const std::vector<InstanceData> &instances)
+{
+    if(mesh.instance_vbo == 0)
+    {
+        glGenBuffers(1, &mesh.instance_vbo);
+
+        glBindVertexArray(mesh.vao);
+        instanceAttributesSetup(mesh.instance_vbo);
+        glBindVertexArray(0);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.instance_vbo);
+    if(instances.size() > mesh.capacity_instances)
+    {
+        mesh.capacity_instances = (unsigned int) instances.size();
+        glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(InstanceData), instances.data(), GL_DYNAMIC_DRAW);
+    }
+    else
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(InstanceData), instances.data());
+    }
+    glCheckError();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    mesh.size_instances = (unsigned int) instances.size();
+}
+
+void meshDrawInstanced(const Mesh &mesh)
+{
+    glBindVertexArray(mesh.vao);
+    glDrawElementsInstanced(GL_TRIANGLES, mesh.size_ibo, mesh.index_type, nullptr, mesh.size_instances);
 }
 
 void meshDelete(const Mesh &mesh)
 {
     glDeleteBuffers(1, &mesh.vbo);
     glDeleteBuffers(1, &mesh.ebo);
+    glDeleteBuffers(1, &mesh.instance_vbo);
     glDeleteVertexArrays(1, &mesh.vao);
 }
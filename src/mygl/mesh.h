@@ -1,15 +1,17 @@
 #pragma once
 
 #include "base.h"
+#include "vertexlayout.h"
+#include "math/bounds.h"
 
+#include <cstdint>
 #include <vector>
 
-enum eDataIdx { Position = 0, Color = 1 };
-
-struct Vertex
+/* per-instance attributes for instanced drawing (see instanced.vert) */
+struct InstanceData
 {
-    Vector3D pos;
-    Vector4D color;
+    Matrix4D model;
+    Vector4D color = {1.0f, 1.0f, 1.0f, 1.0f};
 };
 
 
@@ -21,11 +23,25 @@ struct Mesh
 
     unsigned int size_vbo = 0;
     unsigned int size_ibo = 0;
+    GLenum index_type = GL_UNSIGNED_INT;
+
+    /* optional per-instance attribute buffer, created by meshUpdateInstances() */
+    GLuint instance_vbo = 0;
+    unsigned int size_instances = 0;
+    unsigned int capacity_instances = 0;
+
+    /* object space bounds of the vertex positions, computed by meshCreate() */
+    AABB bounds;
+    BoundingSphere sphere;
+
+    /* maps quantized positions back into bounds, has to be multiplied into the model matrix (identity for float positions) */
+    Matrix4D dequantization = Matrix4D::identity();
 };
 
 /**
  * @brief Initializes all buffer objects (VBO, IBO) required for the mesh and fill it with data. Further, a vertex array
- * object (VAO) is created and the buffer objects are bind to it.
+ * object (VAO) is created and the buffer objects are bind to it. The bounding box and sphere of the positions are stored
+ * in the mesh for culling.
  *
  * @param vertices Data for each vertex of the mesh (position, color, normal and uv coordinate data).
  * @param indices List of indices that form polygons in the mesh.
@@ -36,14 +52,26 @@ struct Mesh
  *
  *   Mesh myMesh = meshCreate(vertex-data, index-data);
  *   glBindVertexArray(myMesh.vao);
- *   glDrawElements(GL_TRIANGLES, myMesh.size_ibo, GL_UNSIGNED_INT, nullptr);
+ *   glDrawElements(GL_TRIANGLES, myMesh.size_ibo, myMesh.index_type, nullptr);
  *
  */
 Mesh meshCreate(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
 
+/**
+ * @brief Initializes all buffer objects (VBO, IBO) required for the mesh and fill it with data, with 16-bit indices for
+ * meshes with at most 65536 vertices (halves the index memory). The mesh has index_type GL_UNSIGNED_SHORT.
+ *
+ * @param vertices Data for each vertex of the mesh (position and color).
+ * @param indices List of indices that form polygons in the mesh.
+ *
+ * @return Initialized mesh structure that can be drawn with OpenGL.
+ */
+Mesh meshCreate(const std::vector<Vertex>& vertices, const std::vector<uint16_t>& indices);
+
 /**
  * @brief Initializes all buffer objects (VBO, IBO) required for the mesh and fill it with data. Further, a vertex array
- * object (VAO) is created and the buffer objects are bind to it.
+ * object (VAO) is created and the buffer objects are bind to it. The bounding box and sphere of the positions are stored
+ * in the mesh for culling.
  *
  * @param positions Position data for each vertex of the mesh.
  * @param indices List of indices that form polygons in the mesh.
@@ -55,11 +83,66 @@ Mesh meshCreate(const std::vector<Vertex>& vertices, const std::vector<unsigned
  *
  *   Mesh myMesh = meshCreate(position-data, index-data, color);
  *   glBindVertexArray(myMesh.vao);
- *   glDrawElements(GL_TRIANGLES, myMesh.size_ibo, GL_UNSIGNED_INT, nullptr);
+ *   glDrawElements(GL_TRIANGLES, myMesh.size_ibo, myMesh.index_type, nullptr);
  *
  */
 Mesh meshCreate(const std::vector<Vector3D>& positions, const std::vector<unsigned int>& indices, const Vector4D& color);
 
+/**
+ * @brief Initializes all buffer objects (VBO, IBO) required for the mesh and fill it with data encoded in a custom vertex
+ * layout (e.g. snorm16 positions and RGBA8 colors). Quantized positions are stored relative to the bounding box of the
+ * mesh, so mesh.dequantization has to be part of the model matrix.
+ *
+ * @param layout Vertex layout the data is encoded in.
+ * @param vertices Data for each vertex of the mesh (position and color).
+ * @param indices List of indices that form polygons in the mesh.
+ * @param normals Normal for each vertex, only needed if the layout contains a normal.
+ *
+ * @return Initialized mesh structure that can be drawn with OpenGL.
+ *
+ * usage:
+ *
+ *   VertexLayout layout = vertexLayoutCreate({PositionSnorm16x4, ColorUnorm8x4});
+ *   Mesh myMesh = meshCreate(layout, vertex-data, index-data);
+ *   ShaderProgram shader = shaderLoad("shader/quantized.vert", "shader/default.frag", vertexLayoutShaderHeader(layout));
+ *   ... model matrix = model * myMesh.dequantization
+ *
+ */
+Mesh meshCreate(const VertexLayout& layout, const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+                const std::vector<Vector3D>& normals = {});
+
+/**
+ * @brief Point the per-instance attributes (eDataIdx::InstanceModel and eDataIdx::InstanceColor) of the currently bound
+ * VAO at a buffer of InstanceData elements.
+ *
+ * @param buffer Buffer holding InstanceData elements.
+ * @param offset Byte offset of the first instance in the buffer.
+ */
+void instanceAttributesSetup(GLuint buffer, GLintptr offset = 0);
+
+/**
+ * @brief Upload per-instance data (model matrix and color) of a mesh. On the first call an instance buffer is created
+ * and bound to the VAO of the mesh with an attribute divisor of one, later calls reuse it and only grow it if needed.
+ *
+ * @param mesh Mesh that gets drawn instanced.
+ * @param instances Data for each instance.
+ *
+ * usage:
+ *
+ *   meshUpdateInstances(myMesh, instance-data);
+ *   meshDrawInstanced(myMesh);
+ *
+ */
+void meshUpdateInstances(Mesh& mesh, const std::vector<InstanceData>& instances);
+
+/**
+ * @brief Draw all instances of a mesh with a single draw call. Requires a shader with the per-instance attributes
+ * (see instanced.vert).
+ *
+ * @param mesh Mesh with instance data.
+ */
+void meshDrawInstanced(const Mesh& mesh);
+
 /**
  * @brief Cleanup and delete all OpenGL buffers of a mesh. Has to be called for each mesh after it is not used anymore.
  *
@@ -0,0 +1,182 @@
+#include "mesharena.h"
+
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace detail
+{
+
+/* upload data into a buffer, growing it if the data does not fit anymore */
+void uploadGrowing(GLenum target, GLuint buffer, unsigned int& capacity, const void* data, unsigned int count, size_t elementSize)
+{
+    glBindBuffer(target, buffer);
+    if(count > capacity)
+    {
+        capacity = count + count / 2;
+        glBufferData(target, capacity * elementSize, nullptr, GL_STREAM_DRAW);
+    }
+    glBufferSubData(target, 0, count * elementSize, data);
+    glCheckError();
+}
+
+}
+
+MeshArena meshArenaCreate(unsigned int vertexCapacity, unsigned int indexCapacity)
+{
+    MeshArena arena;
+    arena.capacity_vertices = vertexCapacity;
+    arena.capacity_indices = indexCapacity;
+    arena.indirect = GLAD_GL_ARB_multi_draw_indirect && GLAD_GL_ARB_base_instance;
+
+    glGenVertexArrays(1, &arena.vao);
+    glGenBuffers(1, &arena.vbo);
+    glGenBuffers(1, &arena.ebo);
+    glGenBuffers(1, &arena.instance_vbo);
+    if(arena.indirect)
+    {
+        glGenBuffers(1, &arena.indirect_buffer);
+    }
+
+    glBindVertexArray(arena.vao);
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, arena.vbo);
+        glBufferData(GL_ARRAY_BUFFER, vertexCapacity * sizeof(Vertex), nullptr, GL_STATIC_DRAW);
+        glCheckError();
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena.ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCapacity * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+        glCheckError();
+
+        glEnableVertexAttribArray(eDataIdx::Position);
+        glEnableVertexAttribArray(eDataIdx::Color);
+        glVertexAttribPointer(eDataIdx::Position,   3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*) offsetof(Vertex, pos));
+        glVertexAttribPointer(eDataIdx::Color,      4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*) offsetof(Vertex, color));
+        glCheckError();
+
+        instanceAttributesSetup(arena.instance_vbo);
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    return arena;
+}
+
+ArenaMesh meshArenaAdd(MeshArena& arena, const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+{
+    if(arena.size_vertices + vertices.size() > arena.capacity_vertices || arena.size_indices + indices.size() > arena.capacity_indices)
+    {
+        std::cerr << "[MeshArena] out of space for a mesh with " << vertices.size() << " vertices and " << indices.size() << " indices" << std::endl;
+        throw std::runtime_error("[MeshArena] out of space");
+    }
+
+    ArenaMesh mesh;
+    mesh.baseVertex = (GLint) arena.size_vertices;
+    mesh.firstIndex = arena.size_indices;
+    mesh.indexCount = (GLuint) indices.size();
+    mesh.vertexCount = (GLuint) vertices.size();
+    mesh.bounds = boundingBox(&vertices.data()->pos, vertices.size(), sizeof(Vertex));
+    mesh.sphere = boundingSphere(&vertices.data()->pos, vertices.size(), sizeof(Vertex));
+
+    /* the element buffer binding is VAO state, so bind the VAO instead of touching whichever VAO is current */
+    glBindVertexArray(arena.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, arena.vbo);
+    glBufferSubData(GL_ARRAY_BUFFER, mesh.baseVertex * sizeof(Vertex), vertices.size() * sizeof(Vertex), vertices.data());
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, mesh.firstIndex * sizeof(unsigned int), indices.size() * sizeof(unsigned int), indices.data());
+    glCheckError();
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    arena.size_vertices += mesh.vertexCount;
+    arena.size_indices += mesh.indexCount;
+
+    return mesh;
+}
+
+ArenaMesh meshArenaAdd(MeshArena& arena, const std::vector<Vector3D>& positions, const std::vector<unsigned int>& indices, const Vector4D& color)
+{
+    std::vector<Vertex> vertices(positions.size());
+    for (unsigned i=0; i<vertices.size(); i++) {
+        vertices[i] = {positions[i], color};
+    }
+
+    return meshArenaAdd(arena, vertices, indices);
+}
+
+void meshArenaDraw(MeshArena& arena, const std::vector<ArenaDraw>& draws)
+{
+    if(draws.empty())
+    {
+        return;
+    }
+
+    arena.instances.clear();
+    arena.commands.clear();
+    arena.counts.clear();
+    arena.offsets.clear();
+    arena.baseVertices.clear();
+    arena.runs.clear();
+
+    glBindVertexArray(arena.vao);
+
+    if(arena.indirect)
+    {
+        for(const ArenaDraw& draw : draws)
+        {
+            GLuint baseInstance = (GLuint) arena.instances.size();
+            arena.instances.push_back(draw.instance);
+            arena.commands.push_back({draw.mesh.indexCount, 1, draw.mesh.firstIndex, draw.mesh.baseVertex, baseInstance});
+        }
+
+        detail::uploadGrowing(GL_ARRAY_BUFFER, arena.instance_vbo, arena.capacity_instances,
+                              arena.instances.data(), (unsigned int) arena.instances.size(), sizeof(InstanceData));
+        detail::uploadGrowing(GL_DRAW_INDIRECT_BUFFER, arena.indirect_buffer, arena.capacity_commands,
+                              arena.commands.data(), (unsigned int) arena.commands.size(), sizeof(DrawElementsIndirectCommand));
+
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, (GLsizei) arena.commands.size(), 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+    else
+    {
+        /* without baseInstance the per-draw data can only be selected by moving the instance attributes, so merge runs
+         * of draws that share their InstanceData (e.g. static geometry with an identity model matrix) */
+        for(const ArenaDraw& draw : draws)
+        {
+            if(arena.instances.empty() || std::memcmp(&arena.instances.back(), &draw.instance, sizeof(InstanceData)) != 0)
+            {
+                arena.instances.push_back(draw.instance);
+                arena.runs.push_back((unsigned int) arena.counts.size());
+            }
+            arena.counts.push_back((GLsizei) draw.mesh.indexCount);
+            arena.offsets.push_back((const void*) (draw.mesh.firstIndex * sizeof(unsigned int)));
+            arena.baseVertices.push_back(draw.mesh.baseVertex);
+        }
+        arena.runs.push_back((unsigned int) arena.counts.size());
+
+        detail::uploadGrowing(GL_ARRAY_BUFFER, arena.instance_vbo, arena.capacity_instances,
+                              arena.instances.data(), (unsigned int) arena.instances.size(), sizeof(InstanceData));
+
+        for(unsigned int run = 0; run + 1 < arena.runs.size(); run++)
+        {
+            instanceAttributesSetup(arena.instance_vbo, run * sizeof(InstanceData));
+            glMultiDrawElementsBaseVertex(GL_TRIANGLES, arena.counts.data() + arena.runs[run], GL_UNSIGNED_INT,
+                                          arena.offsets.data() + arena.runs[run], arena.runs[run + 1] - arena.runs[run],
+                                          arena.baseVertices.data() + arena.runs[run]);
+        }
+        instanceAttributesSetup(arena.instance_vbo);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void meshArenaDelete(const MeshArena& arena)
+{
+    glDeleteBuffers(1, &arena.vbo);
+    glDeleteBuffers(1, &arena.ebo);
+    glDeleteBuffers(1, &arena.instance_vbo);
+    glDeleteBuffers(1, &arena.indirect_buffer);
+    glDeleteVertexArrays(1, &arena.vao);
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "mesh.h"
+
+#include <vector>
+
+/* range of one mesh inside the shared buffers of a MeshArena */
+struct ArenaMesh
+{
+    GLint baseVertex = 0;
+    GLuint firstIndex = 0;
+    GLuint indexCount = 0;
+    GLuint vertexCount = 0;
+
+    /* object space bounds of the vertex positions */
+    AABB bounds;
+    BoundingSphere sphere;
+};
+
+/* one draw of an arena mesh with its per-draw attributes */
+struct ArenaDraw
+{
+    ArenaMesh mesh;
+    InstanceData instance;
+};
+
+/* layout of one command in the GL_DRAW_INDIRECT_BUFFER (DrawElementsIndirectCommand of the GL specification) */
+struct DrawElementsIndirectCommand
+{
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+/*
+ * Shared vertex and index buffers for many meshes of the Vertex layout. All meshes live in one VAO, so a whole list of
+ * draws is submitted without any per-object state change.
+ */
+struct MeshArena
+{
+    GLuint vao = 0;
+    GLuint vbo = 0;
+    GLuint ebo = 0;
+    GLuint instance_vbo = 0;
+    GLuint indirect_buffer = 0;
+
+    unsigned int capacity_vertices = 0;
+    unsigned int capacity_indices = 0;
+    unsigned int size_vertices = 0;
+    unsigned int size_indices = 0;
+    unsigned int capacity_instances = 0;
+    unsigned int capacity_commands = 0;
+
+    /* GL_ARB_multi_draw_indirect and GL_ARB_base_instance are available */
+    bool indirect = false;
+
+    /* CPU side staging of the draw list, reused every frame */
+    std::vector<InstanceData> instances;
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<GLsizei> counts;
+    std::vector<const void*> offsets;
+    std::vector<GLint> baseVertices;
+    std::vector<unsigned int> runs;
+};
+
+/**
+ * @brief Allocate the shared buffers of an arena and set up its VAO for the Vertex layout and the per-draw InstanceData
+ * (see instanced.vert).
+ *
+ * @param vertexCapacity Maximal number of vertices of all meshes in the arena.
+ * @param indexCapacity Maximal number of indices of all meshes in the arena.
+ *
+ * @return Mesh arena.
+ *
+ * usage:
+ *
+ *   MeshArena arena = meshArenaCreate(1 << 20, 1 << 22);
+ *   ArenaMesh cube = meshArenaAdd(arena, cube::vertices, cube::indices);
+ *   meshArenaDraw(arena, {{cube, {model, color}}, ...});
+ */
+MeshArena meshArenaCreate(unsigned int vertexCapacity, unsigned int indexCapacity);
+
+/**
+ * @brief Copy a mesh into the shared buffers of an arena. Indices stay relative to the mesh, the arena offsets them
+ * with the base vertex when drawing.
+ *
+ * @param arena Mesh arena with enough space left (throws otherwise).
+ * @param vertices Data for each vertex of the mesh.
+ * @param indices List of indices that form triangles in the mesh.
+ *
+ * @return Range of the mesh inside the arena.
+ */
+ArenaMesh meshArenaAdd(MeshArena& arena, const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+
+/**
+ * @brief Copy a mesh with a single color into the shared buffers of an arena.
+ *
+ * @param arena Mesh arena with enough space left (throws otherwise).
+ * @param positions Position data for each vertex of the mesh.
+ * @param indices List of indices that form triangles in the mesh.
+ * @param color Color used for each of the vertices of this mesh.
+ *
+ * @return Range of the mesh inside the arena.
+ */
+ArenaMesh meshArenaAdd(MeshArena& arena, const std::vector<Vector3D>& positions, const std::vector<unsigned int>& indices, const Vector4D& color);
+
+/**
+ * @brief Draw a list of arena meshes. With GL_ARB_multi_draw_indirect the whole list is a single
+ * glMultiDrawElementsIndirect call that selects the per-draw data through baseInstance. On plain GL 3.3 consecutive draws
+ * with identical InstanceData are merged into one glMultiDrawElementsBaseVertex call each, so only the instance
+ * attribute offset changes between calls.
+ *
+ * @param arena Mesh arena.
+ * @param draws Draws to submit, requires a shader with the per-instance attributes (see instanced.vert).
+ */
+void meshArenaDraw(MeshArena& arena, const std::vector<ArenaDraw>& draws);
+
+/**
+ * @brief Cleanup and delete all OpenGL buffers of an arena.
+ *
+ * @param arena Mesh arena to delete.
+ */
+void meshArenaDelete(const MeshArena& arena);
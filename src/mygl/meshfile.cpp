@@ -0,0 +1,372 @@
+#include "meshfile.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(MeshFileHeader) % 8 == 0, "MeshFileHeader has to keep its 64-bit offsets aligned");
+static_assert(sizeof(MeshFileAttribute) == 8, "MeshFileAttribute has to be tightly packed");
+
+namespace detail
+{
+
+uint64_t alignUp(uint64_t offset)
+{
+    return (offset + MESHFILE_ALIGNMENT - 1) / MESHFILE_ALIGNMENT * MESHFILE_ALIGNMENT;
+}
+
+void writePadded(std::ofstream& out, const void* data, std::size_t size)
+{
+    static const char zeros[MESHFILE_ALIGNMENT] = {};
+
+    out.write(static_cast<const char*>(data), std::streamsize(size));
+    out.write(zeros, std::streamsize(alignUp(size) - size));
+}
+
+[[noreturn]] void invalidFile(const std::string& filepath, const std::string& reason)
+{
+    std::cerr << "[MeshFile] " << filepath << ": " << reason << std::endl;
+    throw std::runtime_error("[MeshFile] invalid file " + filepath);
+}
+
+/* [offset, offset + size) lies within [0, end), written so that a corrupt offset can't wrap around */
+bool rangeFits(uint64_t offset, uint64_t size, uint64_t end)
+{
+    return offset <= end && size <= end - offset;
+}
+
+/* largest index of the triangle list, the indices are aligned (see MESHFILE_ALIGNMENT) */
+template<typename T>
+uint64_t maxIndex(const void* indices, uint32_t count)
+{
+    const T* values = static_cast<const T*>(indices);
+    T max = 0;
+    for(uint32_t i = 0; i < count; i++)
+    {
+        max = std::max(max, values[i]);
+    }
+    return max;
+}
+
+/* everything the loader relies on is checked once here, a truncated or foreign file must never be read out of bounds */
+void validate(const MeshFile& file, const std::string& filepath)
+{
+    if(file.mapped.size < sizeof(MeshFileHeader))
+    {
+        invalidFile(filepath, "file too small");
+    }
+
+    const MeshFileHeader& header = *file.header;
+    if(header.magic != MESHFILE_MAGIC)
+    {
+        invalidFile(filepath, "not a mesh file");
+    }
+    if(header.version != MESHFILE_VERSION)
+    {
+        invalidFile(filepath, "version " + std::to_string(header.version) + " is not supported (expected " + std::to_string(MESHFILE_VERSION) + ")");
+    }
+    if(header.indexSize != 2 && header.indexSize != 4)
+    {
+        invalidFile(filepath, "index size " + std::to_string(header.indexSize));
+    }
+
+    /* the products of two 32-bit values can't overflow, the sections have to follow each other in the file */
+    const uint64_t attributesSize = uint64_t(header.attributeCount) * sizeof(MeshFileAttribute);
+    const uint64_t vertexSize = uint64_t(header.vertexCount) * header.vertexStride;
+    const uint64_t indexSize = uint64_t(header.indexCount) * header.indexSize;
+    if(header.fileSize != file.mapped.size || header.attributesOffset < sizeof(MeshFileHeader)
+       || !rangeFits(header.indexOffset, indexSize, file.mapped.size)
+       || !rangeFits(header.vertexOffset, vertexSize, header.indexOffset)
+       || !rangeFits(header.attributesOffset, attributesSize, header.vertexOffset)
+       || header.attributesOffset % MESHFILE_ALIGNMENT || header.vertexOffset % MESHFILE_ALIGNMENT || header.indexOffset % MESHFILE_ALIGNMENT)
+    {
+        invalidFile(filepath, "corrupt or truncated");
+    }
+
+    const MeshFileAttribute* attributes = reinterpret_cast<const MeshFileAttribute*>(static_cast<const unsigned char*>(file.mapped.data) + header.attributesOffset);
+    uint32_t usedLocations = 0;
+    for(uint32_t i = 0; i < header.attributeCount; i++)
+    {
+        if(attributes[i].format > NormalOct16x2)
+        {
+            invalidFile(filepath, "attribute " + std::to_string(i) + " has unknown format " + std::to_string(attributes[i].format));
+        }
+
+        const eAttribFormat format = eAttribFormat(attributes[i].format);
+        if(!rangeFits(attributes[i].offset, vertexAttribSize(format), header.vertexStride))
+        {
+            invalidFile(filepath, "attribute " + std::to_string(i) + " does not fit the vertex stride");
+        }
+
+        /* two formats of one attribute would bind the same location twice */
+        const uint32_t location = 1u << vertexAttribLocation(format);
+        if(usedLocations & location)
+        {
+            invalidFile(filepath, "attribute " + std::to_string(i) + " uses location " + std::to_string(vertexAttribLocation(format)) + " twice");
+        }
+        usedLocations |= location;
+    }
+
+    /* an index past the vertices would make the GPU read outside the vertex buffer */
+    if(header.indexCount > 0)
+    {
+        const void* indices = static_cast<const unsigned char*>(file.mapped.data) + header.indexOffset;
+        const uint64_t max = header.indexSize == 2 ? maxIndex<uint16_t>(indices, header.indexCount) : maxIndex<uint32_t>(indices, header.indexCount);
+        if(max >= header.vertexCount)
+        {
+            invalidFile(filepath, "index " + std::to_string(max) + " is out of range (" + std::to_string(header.vertexCount) + " vertices)");
+        }
+    }
+}
+
+}
+
+void meshFileWrite(const std::string& filepath, const VertexLayout& layout, const AABB& bounds, const BoundingSphere& sphere,
+                   const void* vertexData, std::size_t vertexCount, const void* indices, std::size_t indexCount, GLenum indexType)
+{
+    MeshFileHeader header;
+    header.vertexCount = uint32_t(vertexCount);
+    header.vertexStride = uint32_t(layout.stride);
+    header.indexCount = uint32_t(indexCount);
+    header.indexSize = indexType == GL_UNSIGNED_SHORT ? 2 : 4;
+    header.attributeCount = uint32_t(layout.attributes.size());
+
+    const float boundsMin[3] = {bounds.min.x, bounds.min.y, bounds.min.z};
+    const float boundsMax[3] = {bounds.max.x, bounds.max.y, bounds.max.z};
+    const float sphereCenter[3] = {sphere.center.x, sphere.center.y, sphere.center.z};
+    std::copy(boundsMin, boundsMin + 3, header.boundsMin);
+    std::copy(boundsMax, boundsMax + 3, header.boundsMax);
+    std::copy(sphereCenter, sphereCenter + 3, header.sphereCenter);
+    header.sphereRadius = sphere.radius;
+
+    std::vector<MeshFileAttribute> attributes;
+    for(const VertexAttribute& attribute : layout.attributes)
+    {
+        attributes.push_back({uint32_t(attribute.format), uint32_t(attribute.offset)});
+    }
+
+    const std::size_t attributesSize = attributes.size() * sizeof(MeshFileAttribute);
+    const std::size_t vertexSize = vertexCount * layout.stride;
+    const std::size_t indexSize = indexCount * header.indexSize;
+
+    header.attributesOffset = detail::alignUp(sizeof(MeshFileHeader));
+    header.vertexOffset = header.attributesOffset + detail::alignUp(attributesSize);
+    header.indexOffset = header.vertexOffset + detail::alignUp(vertexSize);
+    header.fileSize = header.indexOffset + detail::alignUp(indexSize);
+
+    std::ofstream out(filepath, std::ios::binary | std::ios::trunc);
+    if(!out)
+    {
+        std::cerr << "[MeshFile] could not open " << filepath << " for writing" << std::endl;
+        throw std::runtime_error("[MeshFile] could not write " + filepath);
+    }
+
+    detail::writePadded(out, &header, sizeof(header));
+    detail::writePadded(out, attributes.data(), attributesSize);
+    detail::writePadded(out, vertexData, vertexSize);
+    detail::writePadded(out, indices, indexSize);
+
+    if(!out)
+    {
+        std::cerr << "[MeshFile] write to " << filepath << " failed" << std::endl;
+        throw std::runtime_error("[MeshFile] could not write " + filepath);
+    }
+}
+
+void meshFileWrite(const std::string& filepath, const VertexLayout& layout, const std::vector<Vertex>& vertices,
+                   const std::vector<unsigned int>& indices, const std::vector<Vector3D>& normals)
+{
+    AABB bounds = boundingBox(&vertices.data()->pos, vertices.size(), sizeof(Vertex));
+    BoundingSphere sphere = boundingSphere(&vertices.data()->pos, vertices.size(), sizeof(Vertex));
+    std::vector<unsigned char> data = vertexLayoutEncode(layout, bounds, vertices, normals);
+
+    if(vertices.size() <= 65536)
+    {
+        std::vector<uint16_t> indices16(indices.begin(), indices.end());
+        meshFileWrite(filepath, layout, bounds, sphere, data.data(), vertices.size(), indices16.data(), indices16.size(), GL_UNSIGNED_SHORT);
+    }
+    else
+    {
+        meshFileWrite(filepath, layout, bounds, sphere, data.data(), vertices.size(), indices.data(), indices.size(), GL_UNSIGNED_INT);
+    }
+}
+
+MappedFile mappedFileOpen(const std::string& filepath)
+{
+    MappedFile file;
+
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    LARGE_INTEGER size;
+    if(handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(handle, &size))
+    {
+        if(handle != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(handle);
+        }
+        std::cerr << "[MeshFile] could not open " << filepath << std::endl;
+        throw std::runtime_error("[MeshFile] could not open " + filepath);
+    }
+    file.fileHandle = handle;
+    file.size = std::size_t(size.QuadPart);
+
+    file.mappingHandle = file.size > 0 ? CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    file.data = file.mappingHandle ? MapViewOfFile(file.mappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+#else
+    int fd = open(filepath.c_str(), O_RDONLY);
+    struct stat info;
+    if(fd < 0 || fstat(fd, &info) != 0)
+    {
+        if(fd >= 0)
+        {
+            close(fd);
+        }
+        std::cerr << "[MeshFile] could not open " << filepath << std::endl;
+        throw std::runtime_error("[MeshFile] could not open " + filepath);
+    }
+    file.size = std::size_t(info.st_size);
+
+    /* the mapping keeps the file alive, the descriptor is not needed anymore */
+    void* mapping = file.size > 0 ? mmap(nullptr, file.size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if(mapping != MAP_FAILED)
+    {
+        file.data = mapping;
+        madvise(mapping, file.size, MADV_SEQUENTIAL);
+        madvise(mapping, file.size, MADV_WILLNEED);
+    }
+#endif
+
+    if(file.data == nullptr && file.size > 0)
+    {
+        mappedFileClose(file);
+        std::cerr << "[MeshFile] could not map " << filepath << std::endl;
+        throw std::runtime_error("[MeshFile] could not map " + filepath);
+    }
+    return file;
+}
+
+void mappedFileClose(MappedFile& file)
+{
+#ifdef _WIN32
+    if(file.data)
+    {
+        UnmapViewOfFile(file.data);
+    }
+    if(file.mappingHandle)
+    {
+        CloseHandle(file.mappingHandle);
+    }
+    if(file.fileHandle)
+    {
+        CloseHandle(file.fileHandle);
+    }
+#else
+    if(file.data)
+    {
+        munmap(const_cast<void*>(file.data), file.size);
+    }
+#endif
+
+    file = MappedFile();
+}
+
+MeshFile meshFileOpen(const std::string& filepath)
+{
+    MeshFile file;
+    file.mapped = mappedFileOpen(filepath);
+    if(file.mapped.data == nullptr)
+    {
+        meshFileClose(file);
+        detail::invalidFile(filepath, "file too small");
+    }
+
+    const unsigned char* base = static_cast<const unsigned char*>(file.mapped.data);
+    file.header = reinterpret_cast<const MeshFileHeader*>(base);
+    try
+    {
+        detail::validate(file, filepath);
+    }
+    catch(...)
+    {
+        meshFileClose(file);
+        throw;
+    }
+
+    file.attributes = reinterpret_cast<const MeshFileAttribute*>(base + file.header->attributesOffset);
+    file.vertices = base + file.header->vertexOffset;
+    file.indices = base + file.header->indexOffset;
+    return file;
+}
+
+VertexLayout meshFileLayout(const MeshFile& file)
+{
+    VertexLayout layout;
+    for(uint32_t i = 0; i < file.header->attributeCount; i++)
+    {
+        layout.attributes.push_back({eAttribFormat(file.attributes[i].format), GLuint(file.attributes[i].offset)});
+    }
+    layout.stride = GLsizei(file.header->vertexStride);
+    return layout;
+}
+
+void meshFileClose(MeshFile& file)
+{
+    mappedFileClose(file.mapped);
+    file = MeshFile();
+}
+
+Mesh meshCreate(const MeshFile& file)
+{
+    const MeshFileHeader& header = *file.header;
+    GLuint vao = 0, vbo = 0, ebo = 0;
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glGenBuffers(1, &ebo);
+
+    glBindVertexArray(vao);
+    {
+        /* the driver copies straight out of the page cache */
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(header.vertexCount) * header.vertexStride, file.vertices, GL_STATIC_DRAW);
+        glCheckError();
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, GLsizeiptr(header.indexCount) * header.indexSize, file.indices, GL_STATIC_DRAW);
+        glCheckError();
+
+        vertexLayoutSetup(meshFileLayout(file));
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    Mesh mesh{vao, vbo, ebo, header.vertexCount, header.indexCount, GLenum(header.indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT)};
+    mesh.bounds = AABB{Vector3D(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]),
+                       Vector3D(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2])};
+    mesh.sphere = BoundingSphere{Vector3D(header.sphereCenter[0], header.sphereCenter[1], header.sphereCenter[2]), header.sphereRadius};
+    mesh.dequantization = vertexLayoutDequantization(meshFileLayout(file), mesh.bounds);
+    return mesh;
+}
+
+Mesh meshLoad(const std::string& filepath)
+{
+    MeshFile file = meshFileOpen(filepath);
+    Mesh mesh = meshCreate(file);
+    meshFileClose(file);
+    return mesh;
+}
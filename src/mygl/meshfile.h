@@ -0,0 +1,167 @@
+#pragma once
+
+#include "mesh.h"
+#include "vertexlayout.h"
+#include "math/bounds.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * binary mesh container (.mesh), little endian:
+ *   MeshFileHeader | MeshFileAttribute[attributeCount] | vertex data | index data
+ * every part starts at a multiple of MESHFILE_ALIGNMENT, so the mapped file can be handed to OpenGL as is
+ */
+constexpr uint32_t MESHFILE_MAGIC = 0x4853454d; /* "MESH" */
+constexpr uint32_t MESHFILE_VERSION = 1;
+constexpr uint32_t MESHFILE_ALIGNMENT = 64;
+
+struct MeshFileHeader
+{
+    uint32_t magic = MESHFILE_MAGIC;
+    uint32_t version = MESHFILE_VERSION;
+
+    uint32_t vertexCount = 0;
+    uint32_t vertexStride = 0;
+    uint32_t indexCount = 0;
+    uint32_t indexSize = 0;        /* 2 or 4 bytes */
+    uint32_t attributeCount = 0;
+    uint32_t reserved = 0;
+
+    float boundsMin[3] = {0.0f, 0.0f, 0.0f};
+    float boundsMax[3] = {0.0f, 0.0f, 0.0f};
+    float sphereCenter[3] = {0.0f, 0.0f, 0.0f};
+    float sphereRadius = 0.0f;
+
+    /* byte offsets from the start of the file */
+    uint64_t attributesOffset = 0;
+    uint64_t vertexOffset = 0;
+    uint64_t indexOffset = 0;
+    uint64_t fileSize = 0;
+};
+
+struct MeshFileAttribute
+{
+    uint32_t format;   /* eAttribFormat */
+    uint32_t offset;
+};
+
+/* read-only memory mapping of a whole file, see mappedFileOpen() */
+struct MappedFile
+{
+    const void* data = nullptr;
+    std::size_t size = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
+
+/* read-only view of a memory mapped .mesh file, the pointers are valid until meshFileClose() */
+struct MeshFile
+{
+    const MeshFileHeader* header = nullptr;
+    const MeshFileAttribute* attributes = nullptr;
+    const void* vertices = nullptr;
+    const void* indices = nullptr;
+
+    MappedFile mapped;
+};
+
+/**
+ * @brief Map a whole file read-only into memory, pages are read on first access and the file is read sequentially
+ * ahead. Throws if the file can't be opened or mapped, an empty file has no mapping (data is nullptr).
+ *
+ * @param filepath Path of the file.
+ *
+ * @return Mapping of the file, has to be closed with mappedFileClose().
+ */
+MappedFile mappedFileOpen(const std::string& filepath);
+
+/* unmap a file mapped with mappedFileOpen() */
+void mappedFileClose(MappedFile& file);
+
+/**
+ * @brief Write vertex data that is already encoded in a vertex layout and an index list into a .mesh file.
+ *
+ * @param filepath Path of the file, an existing file is overwritten.
+ * @param layout Vertex layout the vertex data is encoded in.
+ * @param bounds Bounds of the positions (quantized positions have to be encoded against them).
+ * @param sphere Bounding sphere of the positions.
+ * @param vertexData layout.stride * vertexCount bytes of vertex data.
+ * @param vertexCount Number of vertices.
+ * @param indices Index data, either uint16_t or unsigned int.
+ * @param indexCount Number of indices.
+ * @param indexType GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.
+ */
+void meshFileWrite(const std::string& filepath, const VertexLayout& layout, const AABB& bounds, const BoundingSphere& sphere,
+                   const void* vertexData, std::size_t vertexCount, const void* indices, std::size_t indexCount, GLenum indexType);
+
+/**
+ * @brief Encode vertices in a vertex layout and write them with the indices into a .mesh file. Indices are stored with
+ * 16 bits if there are at most 65536 vertices.
+ *
+ * @param filepath Path of the file, an existing file is overwritten.
+ * @param layout Vertex layout to encode the vertices in.
+ * @param vertices Data for each vertex of the mesh (position and color).
+ * @param indices List of indices that form polygons in the mesh.
+ * @param normals Normal for each vertex, only needed if the layout contains a normal.
+ *
+ * usage:
+ *
+ *   meshFileWrite("bunny.mesh", vertexLayoutCreate({PositionSnorm16x4, ColorUnorm8x4}), vertex-data, index-data);
+ */
+void meshFileWrite(const std::string& filepath, const VertexLayout& layout, const std::vector<Vertex>& vertices,
+                   const std::vector<unsigned int>& indices, const std::vector<Vector3D>& normals = {});
+
+/**
+ * @brief Map a .mesh file into memory and validate its header and indices. No data is copied, the index pages are read
+ * once by the validation, vertex pages on first access.
+ *
+ * @param filepath Path of the file.
+ *
+ * @return View of the mapped file, has to be closed with meshFileClose().
+ */
+MeshFile meshFileOpen(const std::string& filepath);
+
+/**
+ * @brief Vertex layout stored in a mapped .mesh file.
+ *
+ * @param file Mapped file.
+ *
+ * @return Vertex layout.
+ */
+VertexLayout meshFileLayout(const MeshFile& file);
+
+/**
+ * @brief Unmap a .mesh file.
+ *
+ * @param file Mapped file.
+ */
+void meshFileClose(MeshFile& file);
+
+/**
+ * @brief Create a mesh from a mapped .mesh file. The vertex and index data are passed to glBufferData straight from the
+ * mapping, the attributes are set up from the stored layout.
+ *
+ * @param file Mapped file.
+ *
+ * @return Initialized mesh structure that can be drawn with OpenGL (use mesh.index_type and mesh.dequantization).
+ */
+Mesh meshCreate(const MeshFile& file);
+
+/**
+ * @brief Map a .mesh file, create a mesh from it and unmap it again.
+ *
+ * @param filepath Path of the file.
+ *
+ * @return Initialized mesh structure that can be drawn with OpenGL (use mesh.index_type and mesh.dequantization).
+ *
+ * usage:
+ *
+ *   Mesh myMesh = meshLoad("assets/bunny.mesh");
+ *   ... model matrix = model * myMesh.dequantization
+ */
+Mesh meshLoad(const std::string& filepath);
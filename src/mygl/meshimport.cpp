@@ -0,0 +1,1066 @@
+#include "meshimport.h"
+#include "meshfile.h"
+#include "math/parallel.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+namespace detail
+{
+
+/*-------------------------- text parsing ---------------------------*/
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool isDigit(char c)
+{
+    return unsigned(c - '0') < 10;
+}
+
+inline void skipSpaces(const char*& p, const char* end)
+{
+    while(p < end && isSpace(*p))
+    {
+        p++;
+    }
+}
+
+inline const char* lineEnd(const char* p, const char* end)
+{
+    const void* newline = std::memchr(p, '\n', std::size_t(end - p));
+    return newline ? static_cast<const char*>(newline) : end;
+}
+
+inline const char* nextLine(const char* p, const char* end)
+{
+    const char* newline = lineEnd(p, end);
+    return newline < end ? newline + 1 : end;
+}
+
+/* all powers of ten that are exact in double precision */
+const double powersOf10[] =
+{
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+double scaleByPowerOf10(double value, int exponent)
+{
+    while(exponent > 22)
+    {
+        value *= 1e22;
+        exponent -= 22;
+    }
+    while(exponent < -22)
+    {
+        value /= 1e22;
+        exponent += 22;
+    }
+    return exponent < 0 ? value / powersOf10[-exponent] : value * powersOf10[exponent];
+}
+
+/* decimal number without locale or stream overhead, up to 19 significant digits are kept (more than a double holds) */
+bool parseNumber(const char*& p, const char* end, double& out)
+{
+    const char* start = p;
+    bool negative = false;
+    if(p < end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        p++;
+    }
+
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    bool any = false;
+
+    for(; p < end && isDigit(*p); p++)
+    {
+        any = true;
+        if(digits < 19)
+        {
+            mantissa = mantissa * 10 + uint64_t(*p - '0');
+            digits += mantissa != 0;
+        }
+        else
+        {
+            exponent++;
+        }
+    }
+    if(p < end && *p == '.')
+    {
+        for(p++; p < end && isDigit(*p); p++)
+        {
+            any = true;
+            if(digits < 19)
+            {
+                mantissa = mantissa * 10 + uint64_t(*p - '0');
+                digits += mantissa != 0;
+                exponent--;
+            }
+        }
+    }
+
+    if(!any)
+    {
+        /* nan and inf are rare enough for the slow path */
+        char token[64];
+        std::size_t length = 0;
+        for(p = start; p < end && !isSpace(*p) && *p != '\n' && length + 1 < sizeof(token); p++)
+        {
+            token[length++] = *p;
+        }
+        token[length] = '\0';
+
+        char* parsed = nullptr;
+        out = std::strtod(token, &parsed);
+        p = start + (parsed - token);
+        return parsed != token;
+    }
+
+    if(p < end && (*p == 'e' || *p == 'E'))
+    {
+        const char* q = p + 1;
+        bool negativeExponent = false;
+        if(q < end && (*q == '-' || *q == '+'))
+        {
+            negativeExponent = *q == '-';
+            q++;
+        }
+        if(q < end && isDigit(*q))
+        {
+            int value = 0;
+            for(; q < end && isDigit(*q); q++)
+            {
+                value = std::min(value * 10 + (*q - '0'), 100000);
+            }
+            exponent += negativeExponent ? -value : value;
+            p = q;
+        }
+    }
+
+    double value = scaleByPowerOf10(double(mantissa), exponent);
+    out = negative ? -value : value;
+    return true;
+}
+
+bool parseFloats(const char*& p, const char* end, float* out, int count)
+{
+    for(int i = 0; i < count; i++)
+    {
+        double value;
+        skipSpaces(p, end);
+        if(!parseNumber(p, end, value))
+        {
+            return false;
+        }
+        out[i] = float(value);
+    }
+    return true;
+}
+
+bool parseInt(const char*& p, const char* end, long long& out)
+{
+    const char* q = p;
+    bool negative = false;
+    if(q < end && (*q == '-' || *q == '+'))
+    {
+        negative = *q == '-';
+        q++;
+    }
+    if(q >= end || !isDigit(*q))
+    {
+        return false;
+    }
+
+    long long value = 0;
+    for(; q < end && isDigit(*q); q++)
+    {
+        value = value * 10 + (*q - '0');
+    }
+    out = negative ? -value : value;
+    p = q;
+    return true;
+}
+
+/*-------------------------- parallel chunks ---------------------------*/
+
+/* chunks below 1 MB do not pay for starting a thread */
+std::size_t chunkCount(std::size_t bytes, unsigned int threads)
+{
+    return std::max<std::size_t>(1, std::min<std::size_t>(threads, bytes >> 20));
+}
+
+/* split [begin, end) into up to count ranges that start at the beginning of a line */
+std::vector<std::pair<const char*, const char*>> splitLines(const char* begin, const char* end, std::size_t count)
+{
+    std::vector<std::pair<const char*, const char*>> ranges;
+    const char* start = begin;
+    for(std::size_t i = 1; i <= count && start < end; i++)
+    {
+        const char* split = i == count ? end : nextLine(std::max(start, begin + std::size_t(end - begin) * i / count), end);
+        ranges.push_back({start, split});
+        start = split;
+    }
+    return ranges;
+}
+
+/* run function(0) ... function(count - 1) as one range each on the shared thread pool */
+template<typename Function>
+void forEachChunk(std::size_t count, Function function)
+{
+    parallelFor(count, unsigned(count), [&](std::size_t begin, std::size_t end)
+    {
+        for(std::size_t i = begin; i < end; i++)
+        {
+            function(i);
+        }
+    });
+}
+
+/*-------------------------- OBJ ---------------------------*/
+
+const int64_t objMissing = -1;
+
+/* negative OBJ indices count back from the current line, possibly into an earlier chunk. They are stored relative to
+   the chunk with this bias and resolved once the chunk offsets are known */
+const int64_t objRelative = int64_t(1) << 62;
+
+struct ObjCorner
+{
+    int64_t v;
+    int64_t vn;
+};
+
+struct ObjChunk
+{
+    std::vector<Vector3D> positions;
+    std::vector<Vector4D> colors;
+    std::vector<Vector3D> normals;
+    std::vector<ObjCorner> corners;     /* three per triangle */
+};
+
+int64_t objIndex(long long index, std::size_t chunkCount)
+{
+    if(index == 0)
+    {
+        throw std::runtime_error("face index 0");
+    }
+    return index > 0 ? int64_t(index - 1) : objRelative + int64_t(chunkCount) + index;
+}
+
+/* "v", "v/vt", "v//vn" or "v/vt/vn", texture coordinates are not part of Vertex and skipped */
+bool parseObjCorner(const char*& p, const char* end, const ObjChunk& chunk, ObjCorner& corner)
+{
+    long long index;
+    if(!parseInt(p, end, index))
+    {
+        return false;
+    }
+    corner.v = objIndex(index, chunk.positions.size());
+    corner.vn = objMissing;
+
+    if(p < end && *p == '/')
+    {
+        p++;
+        parseInt(p, end, index);
+        if(p < end && *p == '/')
+        {
+            p++;
+            if(!parseInt(p, end, index))
+            {
+                return false;
+            }
+            corner.vn = objIndex(index, chunk.normals.size());
+        }
+    }
+    return p == end || isSpace(*p);
+}
+
+void parseObjChunk(const char* begin, const char* end, ObjChunk& chunk)
+{
+    std::vector<ObjCorner> polygon;
+
+    for(const char* line = begin, *last = begin; line < end; line = last + 1)
+    {
+        last = lineEnd(line, end);
+        const char* p = line;
+        skipSpaces(p, last);
+        if(last - p < 2)
+        {
+            continue;
+        }
+
+        const bool isVertex = p[0] == 'v' && isSpace(p[1]);
+        const bool isNormal = last - p >= 3 && p[0] == 'v' && p[1] == 'n' && isSpace(p[2]);
+        const bool isFace = p[0] == 'f' && isSpace(p[1]);
+
+        if(isVertex)
+        {
+            float xyz[3], rgb[3];
+            p += 2;
+            if(!parseFloats(p, last, xyz, 3))
+            {
+                throw std::runtime_error("malformed vertex: " + std::string(line, last));
+            }
+            chunk.positions.push_back(Vector3D(xyz[0], xyz[1], xyz[2]));
+
+            skipSpaces(p, last);
+            if(p < last && parseFloats(p, last, rgb, 3))
+            {
+                chunk.colors.push_back(Vector4D(rgb[0], rgb[1], rgb[2], 1.0f));
+            }
+            else
+            {
+                chunk.colors.push_back(Vector4D(1.0f, 1.0f, 1.0f, 1.0f));
+            }
+        }
+        else if(isNormal)
+        {
+            float n[3];
+            p += 3;
+            if(!parseFloats(p, last, n, 3))
+            {
+                throw std::runtime_error("malformed normal: " + std::string(line, last));
+            }
+            chunk.normals.push_back(Vector3D(n[0], n[1], n[2]));
+        }
+        else if(isFace)
+        {
+            polygon.clear();
+            for(p += 2, skipSpaces(p, last); p < last; skipSpaces(p, last))
+            {
+                ObjCorner corner;
+                if(!parseObjCorner(p, last, chunk, corner))
+                {
+                    throw std::runtime_error("malformed face: " + std::string(line, last));
+                }
+                polygon.push_back(corner);
+            }
+            if(polygon.size() < 3)
+            {
+                throw std::runtime_error("face with less than three corners: " + std::string(line, last));
+            }
+
+            for(std::size_t k = 2; k < polygon.size(); k++)
+            {
+                chunk.corners.push_back(polygon[0]);
+                chunk.corners.push_back(polygon[k - 1]);
+                chunk.corners.push_back(polygon[k]);
+            }
+        }
+        /* vt, comments, groups, materials, lines and points are skipped */
+    }
+}
+
+/* extrapolate the element counts of a chunk from its first 64 KB, reserving them saves most reallocation copies */
+void reserveObjChunk(const char* begin, const char* end, ObjChunk& chunk)
+{
+    const std::size_t sampleSize = 1 << 16;
+    if(std::size_t(end - begin) < 2 * sampleSize)
+    {
+        return;
+    }
+
+    ObjChunk sample;
+    const char* sampleEnd = nextLine(begin + sampleSize, end);
+    parseObjChunk(begin, sampleEnd, sample);
+
+    const double scale = 1.1 * double(end - begin) / double(sampleEnd - begin);
+    chunk.positions.reserve(std::size_t(double(sample.positions.size()) * scale));
+    chunk.colors.reserve(std::size_t(double(sample.colors.size()) * scale));
+    chunk.normals.reserve(std::size_t(double(sample.normals.size()) * scale));
+    chunk.corners.reserve(std::size_t(double(sample.corners.size()) * scale));
+}
+
+void importOBJ(const char* begin, const char* end, unsigned int threads,
+               std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, std::vector<Vector3D>* normals)
+{
+    std::vector<std::pair<const char*, const char*>> ranges = splitLines(begin, end, chunkCount(std::size_t(end - begin), threads));
+    std::vector<ObjChunk> chunks(ranges.size());
+    forEachChunk(ranges.size(), [&](std::size_t i)
+    {
+        reserveObjChunk(ranges[i].first, ranges[i].second, chunks[i]);
+        parseObjChunk(ranges[i].first, ranges[i].second, chunks[i]);
+    });
+
+    std::vector<int64_t> positionOffsets, normalOffsets;
+    std::vector<Vector3D> positions, fileNormals;
+    std::vector<Vector4D> colors;
+    std::size_t cornerCount = 0;
+    for(const ObjChunk& chunk : chunks)
+    {
+        positionOffsets.push_back(int64_t(positions.size()));
+        normalOffsets.push_back(int64_t(fileNormals.size()));
+        positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+        colors.insert(colors.end(), chunk.colors.begin(), chunk.colors.end());
+        fileNormals.insert(fileNormals.end(), chunk.normals.begin(), chunk.normals.end());
+        cornerCount += chunk.corners.size();
+    }
+
+    auto resolve = [](int64_t index, int64_t offset, std::size_t count)
+    {
+        int64_t resolved = index >= objRelative / 2 ? index - objRelative + offset : index;
+        if(resolved < 0 || resolved >= int64_t(count))
+        {
+            throw std::runtime_error("face index " + std::to_string(resolved + 1) + " out of range");
+        }
+        return resolved;
+    };
+
+    /* corners that only differ in their texture coordinate share a vertex, since Vertex has none. The first vertex of
+       each position is looked up directly, only positions used with several normals go through the hash map */
+    const unsigned int unused = ~0u;
+    std::vector<unsigned int> firstVertex(positions.size(), unused);
+    std::vector<int64_t> vertexNormal;
+    std::unordered_map<uint64_t, unsigned int> unique;
+    indices.reserve(cornerCount);
+    vertices.reserve(positions.size());
+    vertexNormal.reserve(positions.size());
+
+    const bool outputNormals = normals && !fileNormals.empty();
+    auto addVertex = [&](int64_t v, int64_t vn)
+    {
+        vertices.push_back({positions[v], colors[v]});
+        vertexNormal.push_back(vn);
+        if(outputNormals)
+        {
+            normals->push_back(vn >= 0 ? fileNormals[vn] : Vector3D(0.0f, 0.0f, 0.0f));
+        }
+        return (unsigned int) (vertices.size() - 1);
+    };
+
+    for(std::size_t c = 0; c < chunks.size(); c++)
+    {
+        for(const ObjCorner& corner : chunks[c].corners)
+        {
+            int64_t v = resolve(corner.v, positionOffsets[c], positions.size());
+            int64_t vn = corner.vn == objMissing ? -1 : resolve(corner.vn, normalOffsets[c], fileNormals.size());
+
+            unsigned int& first = firstVertex[v];
+            if(first == unused)
+            {
+                first = addVertex(v, vn);
+            }
+            else if(vertexNormal[first] != vn)
+            {
+                uint64_t key = uint64_t(v) * (fileNormals.size() + 1) + uint64_t(vn + 1);
+                auto found = unique.find(key);
+                indices.push_back(found != unique.end() ? found->second : unique.emplace(key, addVertex(v, vn)).first->second);
+                continue;
+            }
+            indices.push_back(first);
+        }
+    }
+}
+
+/*-------------------------- PLY ---------------------------*/
+
+enum ePlyType { PlyInt8, PlyUint8, PlyInt16, PlyUint16, PlyInt32, PlyUint32, PlyFloat32, PlyFloat64 };
+enum ePlyFormat { PlyAscii, PlyBinaryLittleEndian, PlyBinaryBigEndian };
+enum ePlyTarget { PlyX, PlyY, PlyZ, PlyNX, PlyNY, PlyNZ, PlyRed, PlyGreen, PlyBlue, PlyAlpha, PlyIgnored };
+
+struct PlyProperty
+{
+    std::string name;
+    ePlyType type = PlyFloat32;
+    bool list = false;
+    ePlyType countType = PlyUint8;
+};
+
+struct PlyElement
+{
+    std::string name;
+    std::size_t count = 0;
+    std::vector<PlyProperty> properties;
+    int indexList = -1;     /* vertex_indices property of faces */
+};
+
+std::size_t plyTypeSize(ePlyType type)
+{
+    switch(type)
+    {
+        case PlyInt8:
+        case PlyUint8:   return 1;
+        case PlyInt16:
+        case PlyUint16:  return 2;
+        case PlyInt32:
+        case PlyUint32:
+        case PlyFloat32: return 4;
+        case PlyFloat64: return 8;
+    }
+    return 0;
+}
+
+ePlyType plyType(const std::string& name)
+{
+    if(name == "char" || name == "int8")        return PlyInt8;
+    if(name == "uchar" || name == "uint8")      return PlyUint8;
+    if(name == "short" || name == "int16")      return PlyInt16;
+    if(name == "ushort" || name == "uint16")    return PlyUint16;
+    if(name == "int" || name == "int32")        return PlyInt32;
+    if(name == "uint" || name == "uint32")      return PlyUint32;
+    if(name == "float" || name == "float32")    return PlyFloat32;
+    if(name == "double" || name == "float64")   return PlyFloat64;
+    throw std::runtime_error("unknown property type " + name);
+}
+
+template<typename T>
+T plyLoad(const char* p, bool swap)
+{
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, p, sizeof(T));
+    if(swap)
+    {
+        std::reverse(bytes, bytes + sizeof(T));
+    }
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+double plyRead(const char* p, ePlyType type, bool swap)
+{
+    switch(type)
+    {
+        case PlyInt8:    return plyLoad<int8_t>(p, swap);
+        case PlyUint8:   return plyLoad<uint8_t>(p, swap);
+        case PlyInt16:   return plyLoad<int16_t>(p, swap);
+        case PlyUint16:  return plyLoad<uint16_t>(p, swap);
+        case PlyInt32:   return plyLoad<int32_t>(p, swap);
+        case PlyUint32:  return plyLoad<uint32_t>(p, swap);
+        case PlyFloat32: return plyLoad<float>(p, swap);
+        case PlyFloat64: return plyLoad<double>(p, swap);
+    }
+    return 0.0;
+}
+
+/* number of entries of a list, read from the count in front of it */
+std::size_t plyListCount(const char* p, const char* end, const PlyElement& element, const PlyProperty& property, bool swap)
+{
+    if(plyTypeSize(property.countType) > std::size_t(end - p))
+    {
+        throw std::runtime_error("unexpected end of file in element " + element.name);
+    }
+    const double count = plyRead(p, property.countType, swap);
+    if(count < 0.0)
+    {
+        throw std::runtime_error("negative list size in element " + element.name);
+    }
+    return std::size_t(count);
+}
+
+/* returns the start of the body */
+const char* parsePlyHeader(const char* begin, const char* end, ePlyFormat& format, std::vector<PlyElement>& elements)
+{
+    const char* line = begin;
+    if(std::string(line, lineEnd(line, end)).compare(0, 3, "ply") != 0)
+    {
+        throw std::runtime_error("missing ply signature");
+    }
+
+    for(line = nextLine(line, end); line < end; line = nextLine(line, end))
+    {
+        std::istringstream tokens(std::string(line, lineEnd(line, end)));
+        std::string keyword;
+        tokens >> keyword;
+
+        if(keyword == "end_header")
+        {
+            return nextLine(line, end);
+        }
+        else if(keyword == "format")
+        {
+            std::string name;
+            tokens >> name;
+            if(name == "ascii")                     format = PlyAscii;
+            else if(name == "binary_little_endian") format = PlyBinaryLittleEndian;
+            else if(name == "binary_big_endian")    format = PlyBinaryBigEndian;
+            else throw std::runtime_error("unknown format " + name);
+        }
+        else if(keyword == "element")
+        {
+            PlyElement element;
+            tokens >> element.name >> element.count;
+            elements.push_back(element);
+        }
+        else if(keyword == "property")
+        {
+            if(elements.empty())
+            {
+                throw std::runtime_error("property outside of an element");
+            }
+
+            PlyProperty property;
+            std::string type;
+            tokens >> type;
+            if(type == "list")
+            {
+                std::string countType, valueType;
+                tokens >> countType >> valueType;
+                property.list = true;
+                property.countType = plyType(countType);
+                property.type = plyType(valueType);
+            }
+            else
+            {
+                property.type = plyType(type);
+            }
+            tokens >> property.name;
+
+            PlyElement& element = elements.back();
+            if(property.list && (property.name == "vertex_indices" || property.name == "vertex_index"))
+            {
+                element.indexList = int(element.properties.size());
+            }
+            element.properties.push_back(property);
+        }
+        /* comment and obj_info lines are skipped */
+    }
+
+    throw std::runtime_error("missing end_header");
+}
+
+/* maps the properties of the vertex element to Vertex members */
+struct PlyVertexMapping
+{
+    std::vector<ePlyTarget> targets;
+    std::vector<float> scales;
+    bool hasNormals = false;
+};
+
+PlyVertexMapping plyVertexMapping(const PlyElement& element)
+{
+    PlyVertexMapping mapping;
+    for(const PlyProperty& property : element.properties)
+    {
+        static const std::pair<const char*, ePlyTarget> names[] =
+        {
+            {"x", PlyX}, {"y", PlyY}, {"z", PlyZ}, {"nx", PlyNX}, {"ny", PlyNY}, {"nz", PlyNZ},
+            {"red", PlyRed}, {"green", PlyGreen}, {"blue", PlyBlue}, {"alpha", PlyAlpha},
+            {"r", PlyRed}, {"g", PlyGreen}, {"b", PlyBlue}, {"a", PlyAlpha}
+        };
+
+        ePlyTarget target = PlyIgnored;
+        for(const auto& name : names)
+        {
+            if(!property.list && property.name == name.first)
+            {
+                target = name.second;
+            }
+        }
+        mapping.hasNormals |= target == PlyNX;
+        mapping.targets.push_back(target);
+
+        /* integer colors are normalized to [0, 1] */
+        float scale = 1.0f;
+        if(target >= PlyRed && target <= PlyAlpha)
+        {
+            if(property.type == PlyUint8 || property.type == PlyInt8)         scale = 1.0f / 255.0f;
+            else if(property.type == PlyUint16 || property.type == PlyInt16)  scale = 1.0f / 65535.0f;
+        }
+        mapping.scales.push_back(scale);
+    }
+    return mapping;
+}
+
+void plyVertex(const PlyVertexMapping& mapping, const double* values, Vertex& vertex, Vector3D& normal)
+{
+    float v[PlyIgnored + 1] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f, 0.0f};
+    for(std::size_t i = 0; i < mapping.targets.size(); i++)
+    {
+        v[mapping.targets[i]] = float(values[i]) * mapping.scales[i];
+    }
+    vertex = {Vector3D(v[PlyX], v[PlyY], v[PlyZ]), Vector4D(v[PlyRed], v[PlyGreen], v[PlyBlue], v[PlyAlpha])};
+    normal = Vector3D(v[PlyNX], v[PlyNY], v[PlyNZ]);
+}
+
+/* read one record, scalar values are stored by property index and the values of the index list are appended to list */
+const char* plyBinaryRecord(const char* p, const char* end, const PlyElement& element, bool swap, double* values, std::vector<long long>* list)
+{
+    for(std::size_t i = 0; i < element.properties.size(); i++)
+    {
+        const PlyProperty& property = element.properties[i];
+        const std::size_t size = plyTypeSize(property.type);
+
+        if(!property.list)
+        {
+            if(size > std::size_t(end - p))
+            {
+                throw std::runtime_error("unexpected end of file in element " + element.name);
+            }
+            values[i] = plyRead(p, property.type, swap);
+            p += size;
+            continue;
+        }
+
+        const std::size_t count = plyListCount(p, end, element, property, swap);
+        p += plyTypeSize(property.countType);
+        if(count > std::size_t(end - p) / size)
+        {
+            throw std::runtime_error("unexpected end of file in element " + element.name);
+        }
+
+        if(list && int(i) == element.indexList)
+        {
+            for(std::size_t k = 0; k < count; k++)
+            {
+                list->push_back((long long) plyRead(p + k * size, property.type, swap));
+            }
+        }
+        p += count * size;
+    }
+    return p;
+}
+
+/* end of a record without converting its values, finds where the records of every thread start */
+const char* plyBinarySkip(const char* p, const char* end, const PlyElement& element, bool swap)
+{
+    for(const PlyProperty& property : element.properties)
+    {
+        std::size_t count = 1;
+        if(property.list)
+        {
+            count = plyListCount(p, end, element, property, swap);
+            p += plyTypeSize(property.countType);
+        }
+        if(count > std::size_t(end - p) / plyTypeSize(property.type))
+        {
+            throw std::runtime_error("unexpected end of file in element " + element.name);
+        }
+        p += count * plyTypeSize(property.type);
+    }
+    return p;
+}
+
+void plyAsciiRecord(const char*& p, const char* end, const PlyElement& element, double* values, std::vector<long long>* list)
+{
+    for(std::size_t i = 0; i < element.properties.size(); i++)
+    {
+        const PlyProperty& property = element.properties[i];
+        skipSpaces(p, end);
+
+        if(!property.list)
+        {
+            if(!parseNumber(p, end, values[i]))
+            {
+                throw std::runtime_error("malformed " + element.name + " property " + property.name);
+            }
+            continue;
+        }
+
+        long long count;
+        if(!parseInt(p, end, count) || count < 0)
+        {
+            throw std::runtime_error("malformed " + element.name + " list " + property.name);
+        }
+        for(long long k = 0; k < count; k++)
+        {
+            double value;
+            skipSpaces(p, end);
+            if(!parseNumber(p, end, value))
+            {
+                throw std::runtime_error("malformed " + element.name + " list " + property.name);
+            }
+            if(list && int(i) == element.indexList)
+            {
+                list->push_back((long long) value);
+            }
+        }
+    }
+}
+
+void appendPolygon(const std::vector<long long>& polygon, std::size_t vertexCount, std::vector<unsigned int>& indices)
+{
+    for(long long index : polygon)
+    {
+        if(index < 0 || index >= (long long) vertexCount)
+        {
+            throw std::runtime_error("face index " + std::to_string(index) + " out of range");
+        }
+    }
+    for(std::size_t k = 2; k < polygon.size(); k++)
+    {
+        indices.push_back((unsigned int) polygon[0]);
+        indices.push_back((unsigned int) polygon[k - 1]);
+        indices.push_back((unsigned int) polygon[k]);
+    }
+}
+
+/* smallest number of bytes a record can take: the fixed properties and the counts of empty lists, or one line */
+std::size_t plyMinRecordSize(const PlyElement& element, ePlyFormat format)
+{
+    if(format == PlyAscii)
+    {
+        return 1;
+    }
+    std::size_t size = 0;
+    for(const PlyProperty& property : element.properties)
+    {
+        size += plyTypeSize(property.list ? property.countType : property.type);
+    }
+    return std::max<std::size_t>(1, size);
+}
+
+struct PlyChunk
+{
+    std::vector<Vertex> vertices;
+    std::vector<Vector3D> normals;
+    std::vector<unsigned int> indices;
+};
+
+void importPLY(const char* begin, const char* end, unsigned int threads,
+               std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, std::vector<Vector3D>* normals)
+{
+    ePlyFormat format = PlyAscii;
+    std::vector<PlyElement> elements;
+    const char* p = parsePlyHeader(begin, end, format, elements);
+
+    const bool swap = format == PlyBinaryBigEndian;
+    std::vector<Vector3D> fileNormals;
+    bool hasNormals = false;
+
+    for(const PlyElement& element : elements)
+    {
+        const bool isVertex = element.name == "vertex";
+        const bool isFace = element.name == "face" && element.indexList >= 0;
+        const PlyVertexMapping mapping = plyVertexMapping(element);
+
+        /* the count comes from the header, it must not allocate more records than the file can hold */
+        if(element.count > std::size_t(end - p) / plyMinRecordSize(element, format))
+        {
+            throw std::runtime_error("element " + element.name + " count " + std::to_string(element.count) + " exceeds the file size");
+        }
+
+        if(isVertex)
+        {
+            hasNormals = mapping.hasNormals;
+            vertices.resize(element.count);
+            fileNormals.resize(element.count);
+        }
+
+        if(format != PlyAscii)
+        {
+            bool fixedSize = true;
+            std::size_t stride = 0;
+            for(const PlyProperty& property : element.properties)
+            {
+                fixedSize &= !property.list;
+                stride += plyTypeSize(property.type);
+            }
+
+            if(isVertex && fixedSize)
+            {
+                /* records have a fixed size, so every thread can start at its own record */
+                if(element.count > std::size_t(end - p) / std::max<std::size_t>(1, stride))
+                {
+                    throw std::runtime_error("unexpected end of file in element vertex");
+                }
+                const std::size_t chunks = chunkCount(element.count * stride, threads);
+                forEachChunk(chunks, [&](std::size_t c)
+                {
+                    std::vector<double> record(element.properties.size());
+                    for(std::size_t i = element.count * c / chunks; i < element.count * (c + 1) / chunks; i++)
+                    {
+                        plyBinaryRecord(p + i * stride, end, element, swap, record.data(), nullptr);
+                        plyVertex(mapping, record.data(), vertices[i], fileNormals[i]);
+                    }
+                });
+                p += element.count * stride;
+                continue;
+            }
+
+            /* variable sized records (face lists): a serial pass that only reads the list sizes finds where the
+               records of every thread start, then the records are converted in parallel */
+            const std::size_t chunks = std::min(std::max<std::size_t>(1, element.count), chunkCount(std::size_t(end - p), threads));
+            std::vector<const char*> starts(chunks);
+            for(std::size_t c = 0, i = 0; c < chunks; c++)
+            {
+                starts[c] = p;
+                for(; i < element.count * (c + 1) / chunks; i++)
+                {
+                    p = plyBinarySkip(p, end, element, swap);
+                }
+            }
+            if(!isVertex && !isFace)
+            {
+                continue;
+            }
+
+            std::vector<PlyChunk> parsed(chunks);
+            const std::size_t vertexCount = vertices.size();
+            forEachChunk(chunks, [&](std::size_t c)
+            {
+                std::vector<double> record(element.properties.size());
+                std::vector<long long> polygon;
+                const char* q = starts[c];
+                for(std::size_t i = element.count * c / chunks; i < element.count * (c + 1) / chunks; i++)
+                {
+                    polygon.clear();
+                    q = plyBinaryRecord(q, end, element, swap, record.data(), isFace ? &polygon : nullptr);
+                    if(isVertex)
+                    {
+                        plyVertex(mapping, record.data(), vertices[i], fileNormals[i]);
+                    }
+                    else
+                    {
+                        appendPolygon(polygon, vertexCount, parsed[c].indices);
+                    }
+                }
+            });
+            for(const PlyChunk& chunk : parsed)
+            {
+                indices.insert(indices.end(), chunk.indices.begin(), chunk.indices.end());
+            }
+            continue;
+        }
+
+        /* ASCII: one record per line, the lines of the element are split across threads */
+        const char* elementBegin = p;
+        for(std::size_t i = 0; i < element.count; i++)
+        {
+            if(p >= end)
+            {
+                throw std::runtime_error("unexpected end of file in element " + element.name);
+            }
+            p = nextLine(p, end);
+        }
+        if(!isVertex && !isFace)
+        {
+            continue;
+        }
+
+        std::vector<std::pair<const char*, const char*>> ranges = splitLines(elementBegin, p, chunkCount(std::size_t(p - elementBegin), threads));
+        std::vector<PlyChunk> chunks(ranges.size());
+        const std::size_t vertexCount = vertices.size();
+
+        forEachChunk(ranges.size(), [&](std::size_t c)
+        {
+            std::vector<double> record(element.properties.size());
+            std::vector<long long> polygon;
+            for(const char* line = ranges[c].first; line < ranges[c].second; line = nextLine(line, ranges[c].second))
+            {
+                const char* q = line;
+                polygon.clear();
+                plyAsciiRecord(q, lineEnd(line, ranges[c].second), element, record.data(), isFace ? &polygon : nullptr);
+                if(isVertex)
+                {
+                    chunks[c].vertices.emplace_back();
+                    chunks[c].normals.emplace_back();
+                    plyVertex(mapping, record.data(), chunks[c].vertices.back(), chunks[c].normals.back());
+                }
+                else
+                {
+                    appendPolygon(polygon, vertexCount, chunks[c].indices);
+                }
+            }
+        });
+
+        std::size_t offset = 0;
+        for(const PlyChunk& chunk : chunks)
+        {
+            if(isVertex)
+            {
+                std::copy(chunk.vertices.begin(), chunk.vertices.end(), vertices.begin() + offset);
+                std::copy(chunk.normals.begin(), chunk.normals.end(), fileNormals.begin() + offset);
+                offset += chunk.vertices.size();
+            }
+            else
+            {
+                indices.insert(indices.end(), chunk.indices.begin(), chunk.indices.end());
+            }
+        }
+    }
+
+    if(normals && hasNormals)
+    {
+        normals->swap(fileNormals);
+    }
+}
+
+}
+
+void meshImport(const std::string& filepath, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices,
+                std::vector<Vector3D>* normals, MeshImportStats* stats, unsigned int threads)
+{
+    auto start = std::chrono::steady_clock::now();
+    threads = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+
+    std::string extension = filepath.substr(std::min(filepath.size(), filepath.find_last_of('.')));
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return char(std::tolower(c)); });
+
+    vertices.clear();
+    indices.clear();
+    if(normals)
+    {
+        normals->clear();
+    }
+
+    std::size_t bytes = 0;
+    try
+    {
+        if(extension != ".obj" && extension != ".ply")
+        {
+            throw std::runtime_error("unknown file extension '" + extension + "' (supported: .obj, .ply)");
+        }
+
+        /* parsed straight out of the page cache, no copy of the file is made */
+        MappedFile file = mappedFileOpen(filepath);
+        const char* data = static_cast<const char*>(file.data);
+        bytes = file.size;
+        try
+        {
+            if(extension == ".obj")
+            {
+                detail::importOBJ(data, data + file.size, threads, vertices, indices, normals);
+            }
+            else
+            {
+                detail::importPLY(data, data + file.size, threads, vertices, indices, normals);
+            }
+        }
+        catch(...)
+        {
+            mappedFileClose(file);
+            throw;
+        }
+        mappedFileClose(file);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "[MeshImport] " << filepath << ": " << e.what() << std::endl;
+        throw std::runtime_error("[MeshImport] could not import " + filepath);
+    }
+
+    if(stats)
+    {
+        stats->bytes = bytes;
+        stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        stats->threads = threads;
+    }
+}
+
+double meshImportThroughput(const MeshImportStats& stats)
+{
+    return stats.seconds > 0.0 ? double(stats.bytes) / (1024.0 * 1024.0) / stats.seconds : 0.0;
+}
+
+const std::string toString(const MeshImportStats& stats)
+{
+    return std::to_string(double(stats.bytes) / (1024.0 * 1024.0)) + " MB in " + std::to_string(stats.seconds) + " s ("
+        + std::to_string(meshImportThroughput(stats)) + " MB/s, " + std::to_string(stats.threads) + " threads)";
+}
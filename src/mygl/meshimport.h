@@ -0,0 +1,46 @@
+#pragma once
+
+#include "vertexlayout.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/* result of meshImport(), the time covers reading and parsing the file */
+struct MeshImportStats
+{
+    std::size_t bytes = 0;
+    double seconds = 0.0;
+    unsigned int threads = 1;
+};
+
+/**
+ * @brief Load a Wavefront OBJ or PLY (ASCII, binary little or big endian) file. The file is memory mapped and split into
+ * chunks that are parsed in parallel: text at line boundaries, fixed size binary records directly and variable size
+ * binary records (face lists) after a serial pass over the list sizes. OBJ corners are deduplicated by their position
+ * and normal index and polygons are triangulated as fans. Vertex colors are read from PLY color properties and the "v x y z r g b" OBJ extension,
+ * vertices without color are white. Throws on malformed files.
+ *
+ * @param filepath Path of the .obj or .ply file.
+ * @param vertices Output vertices (position and color).
+ * @param indices Output triangle list.
+ * @param normals Optional output normal of each vertex, left empty if the file has no normals.
+ * @param stats Optional output of file size, time and throughput.
+ * @param threads Number of parser threads, 0 uses all hardware threads.
+ *
+ * usage:
+ *
+ *   std::vector<Vertex> vertices;
+ *   std::vector<unsigned int> indices;
+ *   MeshImportStats stats;
+ *   meshImport("assets/bunny.ply", vertices, indices, nullptr, &stats);
+ *   Mesh myMesh = meshCreate(vertices, indices);
+ *   std::cout << toString(stats) << std::endl;
+ */
+void meshImport(const std::string& filepath, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices,
+                std::vector<Vector3D>* normals = nullptr, MeshImportStats* stats = nullptr, unsigned int threads = 0);
+
+/* parse throughput in MB/s */
+double meshImportThroughput(const MeshImportStats& stats);
+
+const std::string toString(const MeshImportStats& stats);
@@ -0,0 +1,331 @@
+#include "meshoptimize.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace detail
+{
+
+/* bitwise hash and equality, Vertex has no padding (7 floats) */
+struct VertexHash
+{
+    std::size_t operator()(const Vertex& v) const
+    {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&v);
+        std::size_t hash = 14695981039346656037ull;
+        for(std::size_t i = 0; i < sizeof(Vertex); i++)
+        {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+};
+
+struct VertexEqual
+{
+    bool operator()(const Vertex& a, const Vertex& b) const
+    {
+        return std::memcmp(&a, &b, sizeof(Vertex)) == 0;
+    }
+};
+
+/* triangle fan of every vertex (triangles using it) as offsets into one list */
+void buildAdjacency(const std::vector<unsigned int>& indices, std::size_t vertexCount,
+                    std::vector<unsigned int>& offsets, std::vector<unsigned int>& triangles)
+{
+    offsets.assign(vertexCount + 1, 0);
+    for(unsigned int index : indices)
+    {
+        offsets[index + 1]++;
+    }
+    for(std::size_t v = 0; v < vertexCount; v++)
+    {
+        offsets[v + 1] += offsets[v];
+    }
+
+    std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+    triangles.resize(indices.size());
+    for(std::size_t i = 0; i < indices.size(); i++)
+    {
+        triangles[fill[indices[i]]++] = (unsigned int) (i / 3);
+    }
+}
+
+/* clusters whose triangles face away from the mesh center occlude the others and go first (Sander et al. 2007) */
+void sortClusters(const std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, const std::vector<std::size_t>& clusterStarts)
+{
+    const std::size_t triangleCount = indices.size() / 3;
+
+    Vector3D meshCenter(0, 0, 0);
+    for(unsigned int index : indices)
+    {
+        meshCenter += vertices[index].pos;
+    }
+    meshCenter /= float(std::max<std::size_t>(indices.size(), 1));
+
+    struct Cluster
+    {
+        std::size_t begin, end;
+        float sortKey;
+    };
+    std::vector<Cluster> clusters;
+
+    for(std::size_t c = 0; c < clusterStarts.size(); c++)
+    {
+        std::size_t begin = clusterStarts[c];
+        std::size_t end = c + 1 < clusterStarts.size() ? clusterStarts[c + 1] : triangleCount;
+
+        Vector3D center(0, 0, 0), normal(0, 0, 0);
+        for(std::size_t t = begin; t < end; t++)
+        {
+            const Vector3D& a = vertices[indices[3 * t + 0]].pos;
+            const Vector3D& b = vertices[indices[3 * t + 1]].pos;
+            const Vector3D& d = vertices[indices[3 * t + 2]].pos;
+            center += (a + b + d) / 3.0f;
+            normal += cross(b - a, d - a);
+        }
+        center /= float(end - begin);
+
+        float normalLength = length(normal);
+        float sortKey = normalLength > 0.0f ? dot(center - meshCenter, normal / normalLength) : 0.0f;
+        clusters.push_back({begin, end, sortKey});
+    }
+
+    std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+    std::vector<unsigned int> sorted;
+    sorted.reserve(indices.size());
+    for(const Cluster& cluster : clusters)
+    {
+        sorted.insert(sorted.end(), indices.begin() + 3 * cluster.begin, indices.begin() + 3 * cluster.end);
+    }
+    indices.swap(sorted);
+}
+
+}
+
+float meshACMR(const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize)
+{
+    if(indices.size() < 3)
+    {
+        return 0.0f;
+    }
+
+    /* a vertex is in the FIFO if fewer than cacheSize vertices were inserted after it */
+    std::vector<long long> insertedAt(vertexCount, -(long long) cacheSize - 1);
+    long long misses = 0;
+
+    for(unsigned int index : indices)
+    {
+        if(misses - insertedAt[index] > (long long) cacheSize)
+        {
+            insertedAt[index] = misses++;
+        }
+    }
+
+    return float(misses) / float(indices.size() / 3);
+}
+
+void meshDeduplicate(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+    std::unordered_map<Vertex, unsigned int, detail::VertexHash, detail::VertexEqual> unique;
+    unique.reserve(vertices.size());
+
+    std::vector<unsigned int> remap(vertices.size());
+    std::vector<Vertex> result;
+    result.reserve(vertices.size());
+
+    for(std::size_t v = 0; v < vertices.size(); v++)
+    {
+        auto inserted = unique.emplace(vertices[v], (unsigned int) result.size());
+        if(inserted.second)
+        {
+            result.push_back(vertices[v]);
+        }
+        remap[v] = inserted.first->second;
+    }
+
+    for(unsigned int& index : indices)
+    {
+        index = remap[index];
+    }
+    vertices.swap(result);
+}
+
+void meshOptimizeVertexCache(const std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, unsigned int cacheSize, bool reduceOverdraw)
+{
+    /* clusters are only cut at dead ends after at least this many triangles, smaller clusters cost too many cache misses */
+    const std::size_t minClusterSize = 64;
+
+    const std::size_t vertexCount = vertices.size();
+    const std::size_t triangleCount = indices.size() / 3;
+    if(triangleCount == 0)
+    {
+        return;
+    }
+
+    std::vector<unsigned int> offsets, adjacency;
+    detail::buildAdjacency(indices, vertexCount, offsets, adjacency);
+
+    /* live triangle count and the time stamp of the last cache insertion of each vertex */
+    std::vector<int> live(vertexCount);
+    for(std::size_t v = 0; v < vertexCount; v++)
+    {
+        live[v] = int(offsets[v + 1] - offsets[v]);
+    }
+    std::vector<int> cacheTime(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+
+    std::vector<unsigned int> deadEnd, candidates, result;
+    std::vector<std::size_t> clusterStarts{0};
+    result.reserve(indices.size());
+
+    const int k = int(cacheSize);
+    int time = k + 1;
+    std::size_t cursor = 0;
+    long long fanning = 0;
+
+    while(fanning >= 0)
+    {
+        /* emit all remaining triangles around the fanning vertex */
+        candidates.clear();
+        for(unsigned int i = offsets[fanning]; i < offsets[fanning + 1]; i++)
+        {
+            unsigned int t = adjacency[i];
+            if(emitted[t])
+            {
+                continue;
+            }
+
+            for(int j = 0; j < 3; j++)
+            {
+                unsigned int v = indices[3 * t + j];
+                result.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+                if(time - cacheTime[v] > k)
+                {
+                    cacheTime[v] = time++;
+                }
+            }
+            emitted[t] = true;
+        }
+
+        /* next fanning vertex: the oldest candidate that is still in the cache after emitting its triangles */
+        long long next = -1;
+        int bestPriority = -1;
+        for(unsigned int v : candidates)
+        {
+            if(live[v] <= 0)
+            {
+                continue;
+            }
+
+            int priority = 0;
+            if(time - cacheTime[v] + 2 * live[v] <= k)
+            {
+                priority = time - cacheTime[v];
+            }
+            if(priority > bestPriority)
+            {
+                bestPriority = priority;
+                next = v;
+            }
+        }
+
+        /* dead end: recently used vertices first, then the next unprocessed vertex in input order */
+        if(next == -1)
+        {
+            while(!deadEnd.empty() && next == -1)
+            {
+                unsigned int v = deadEnd.back();
+                deadEnd.pop_back();
+                if(live[v] > 0)
+                {
+                    next = v;
+                }
+            }
+            while(next == -1 && cursor < vertexCount)
+            {
+                if(live[cursor] > 0)
+                {
+                    next = (long long) cursor;
+                }
+                cursor++;
+            }
+
+            std::size_t emittedTriangles = result.size() / 3;
+            if(next != -1 && emittedTriangles - clusterStarts.back() >= minClusterSize)
+            {
+                clusterStarts.push_back(emittedTriangles);
+            }
+        }
+
+        fanning = next;
+    }
+
+    indices.swap(result);
+
+    if(reduceOverdraw && clusterStarts.size() > 1)
+    {
+        detail::sortClusters(vertices, indices, clusterStarts);
+    }
+}
+
+void meshOptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+    const unsigned int unused = ~0u;
+    std::vector<unsigned int> remap(vertices.size(), unused);
+    std::vector<Vertex> result;
+    result.reserve(vertices.size());
+
+    for(unsigned int& index : indices)
+    {
+        if(remap[index] == unused)
+        {
+            remap[index] = (unsigned int) result.size();
+            result.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices.swap(result);
+}
+
+MeshOptimizeStats meshOptimize(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+    MeshOptimizeStats stats;
+    stats.verticesBefore = (unsigned int) vertices.size();
+    stats.acmrBefore = meshACMR(indices, (unsigned int) vertices.size());
+
+    meshDeduplicate(vertices, indices);
+    meshOptimizeVertexCache(vertices, indices);
+    meshOptimizeVertexFetch(vertices, indices);
+
+    stats.verticesAfter = (unsigned int) vertices.size();
+    stats.acmrAfter = meshACMR(indices, (unsigned int) vertices.size());
+    return stats;
+}
+
+Mesh meshCreateOptimized(std::vector<Vertex> vertices, std::vector<unsigned int> indices, MeshOptimizeStats* stats)
+{
+    MeshOptimizeStats result = meshOptimize(vertices, indices);
+    if(stats)
+    {
+        *stats = result;
+    }
+
+    if(vertices.size() <= 65536)
+    {
+        std::vector<uint16_t> indices16(indices.begin(), indices.end());
+        return meshCreate(vertices, indices16);
+    }
+    return meshCreate(vertices, indices);
+}
+
+const std::string toString(const MeshOptimizeStats& stats)
+{
+    return "vertices: " + std::to_string(stats.verticesBefore) + " -> " + std::to_string(stats.verticesAfter)
+        + ", ACMR: " + std::to_string(stats.acmrBefore) + " -> " + std::to_string(stats.acmrAfter);
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "mesh.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* result of meshOptimize(), ACMR is the average number of vertex shader invocations per triangle (lower is better) */
+struct MeshOptimizeStats
+{
+    unsigned int verticesBefore = 0;
+    unsigned int verticesAfter = 0;
+    float acmrBefore = 0.0f;
+    float acmrAfter = 0.0f;
+};
+
+/**
+ * @brief Simulate a FIFO post-transform vertex cache and compute the average cache miss ratio of a triangle list.
+ *
+ * @param indices Triangle list.
+ * @param vertexCount Number of vertices the indices refer to.
+ * @param cacheSize Number of cache entries.
+ *
+ * @return Transformed vertices per triangle, between 0.5 (ideal grid) and 3 (no reuse).
+ */
+float meshACMR(const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize = 16);
+
+/**
+ * @brief Merge bitwise identical vertices and remap the indices.
+ *
+ * @param vertices Vertices, shrunk to the unique ones.
+ * @param indices Triangle list, remapped.
+ */
+void meshDeduplicate(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+/**
+ * @brief Reorder triangles for the post-transform vertex cache (Tipsify, Sander et al. 2007). Optionally the resulting
+ * clusters are sorted so that outward facing triangles on the convex side are drawn first, which reduces overdraw.
+ *
+ * @param vertices Vertices (positions are needed for the overdraw sort).
+ * @param indices Triangle list, reordered in place.
+ * @param cacheSize Cache size the order is tuned for.
+ * @param reduceOverdraw Sort clusters by their occlusion potential.
+ */
+void meshOptimizeVertexCache(const std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, unsigned int cacheSize = 16, bool reduceOverdraw = true);
+
+/**
+ * @brief Reorder vertices by their first use in the index buffer, so that vertex fetches walk memory linearly.
+ * Unreferenced vertices are dropped.
+ *
+ * @param vertices Vertices, reordered.
+ * @param indices Triangle list, remapped.
+ */
+void meshOptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+/**
+ * @brief Run deduplication, vertex cache and overdraw ordering and vertex fetch ordering.
+ *
+ * @param vertices Vertices, optimized in place.
+ * @param indices Triangle list, optimized in place.
+ *
+ * @return Vertex counts and ACMR before and after.
+ */
+MeshOptimizeStats meshOptimize(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+/**
+ * @brief Optimize the mesh data (see meshOptimize()) and upload it, with 16-bit indices if there are at most 65536
+ * vertices.
+ *
+ * @param vertices Data for each vertex of the mesh.
+ * @param indices Triangle list.
+ * @param stats Optional output of the optimization statistics.
+ *
+ * @return Initialized mesh structure that can be drawn with OpenGL (use mesh.index_type).
+ *
+ * usage:
+ *
+ *   MeshOptimizeStats stats;
+ *   Mesh myMesh = meshCreateOptimized(vertex-data, index-data, &stats);
+ *   std::cout << toString(stats) << std::endl;
+ */
+Mesh meshCreateOptimized(std::vector<Vertex> vertices, std::vector<unsigned int> indices, MeshOptimizeStats* stats = nullptr);
+
+const std::string toString(const MeshOptimizeStats& stats);
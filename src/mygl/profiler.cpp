@@ -0,0 +1,318 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace detail
+{
+
+/* a scope whose GPU timestamps are not read back yet */
+struct GpuScope
+{
+    const char* name = nullptr;
+    unsigned int depth = 0;
+    unsigned int queryBegin = 0;
+    unsigned int queryEnd = 0;
+};
+
+/* one slot of the query ring, the queries are created on demand and reused by every frame of the slot */
+struct ProfilerFrame
+{
+    std::vector<GLuint> queries;
+    unsigned int queriesUsed = 0;
+    std::vector<GpuScope> scopes;
+    unsigned int frame = 0;
+    double gpuOffset = 0.0;
+    bool pending = false;
+};
+
+/* a scope that is not ended yet */
+struct OpenScope
+{
+    const char* name;
+    double start;
+    int gpuScope;
+};
+
+struct ProfilerTotals
+{
+    const char* name = nullptr;
+    double cpu = 0.0;
+    double gpu = 0.0;
+    unsigned int cpuCount = 0;
+    unsigned int gpuCount = 0;
+};
+
+}
+
+struct Profiler
+{
+    std::chrono::steady_clock::time_point origin;
+    bool gpuTimers = false;
+
+    std::vector<detail::ProfilerFrame> frames;
+    unsigned int frame = 0;
+    std::vector<detail::OpenScope> open;
+
+    std::vector<ProfilerEvent> events;
+    std::size_t maxEvents = 0;
+    std::vector<detail::ProfilerTotals> totals;
+    unsigned int stalls = 0;
+};
+
+namespace detail
+{
+
+double profilerNow(const Profiler* profiler)
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - profiler->origin).count();
+}
+
+ProfilerFrame& currentFrame(Profiler* profiler)
+{
+    return profiler->frames[profiler->frame % profiler->frames.size()];
+}
+
+GLuint nextQuery(ProfilerFrame& frame, unsigned int& index)
+{
+    if(frame.queriesUsed == frame.queries.size())
+    {
+        GLuint query = 0;
+        glGenQueries(1, &query);
+        frame.queries.push_back(query);
+    }
+    index = frame.queriesUsed++;
+    return frame.queries[index];
+}
+
+void record(Profiler* profiler, const ProfilerEvent& event)
+{
+    ProfilerTotals* totals = nullptr;
+    for(ProfilerTotals& t : profiler->totals)
+    {
+        if(t.name == event.name || std::string(t.name) == event.name)
+        {
+            totals = &t;
+            break;
+        }
+    }
+    if(totals == nullptr)
+    {
+        profiler->totals.push_back({event.name});
+        totals = &profiler->totals.back();
+    }
+    (event.gpu ? totals->gpu : totals->cpu) += event.duration;
+    (event.gpu ? totals->gpuCount : totals->cpuCount)++;
+
+    if(profiler->events.size() < profiler->maxEvents)
+    {
+        profiler->events.push_back(event);
+    }
+}
+
+/* read all timestamps of a frame, waits for the last one if the GPU did not get there yet */
+void resolve(Profiler* profiler, ProfilerFrame& frame)
+{
+    if(!frame.pending)
+    {
+        return;
+    }
+    frame.pending = false;
+
+    if(frame.queriesUsed > 0)
+    {
+        GLint available = 0;
+        glGetQueryObjectiv(frame.queries[frame.queriesUsed - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if(!available)
+        {
+            profiler->stalls++;
+        }
+    }
+
+    for(const GpuScope& scope : frame.scopes)
+    {
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(frame.queries[scope.queryBegin], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(frame.queries[scope.queryEnd], GL_QUERY_RESULT, &end);
+
+        ProfilerEvent event;
+        event.name = scope.name;
+        event.start = double(begin) / 1000.0 + frame.gpuOffset;
+        event.duration = double(end - begin) / 1000.0;
+        event.frame = frame.frame;
+        event.depth = scope.depth;
+        event.gpu = true;
+        record(profiler, event);
+    }
+    frame.scopes.clear();
+    frame.queriesUsed = 0;
+}
+
+void writeEscaped(std::ostream& out, const char* text)
+{
+    for(const char* c = text; *c != '\0'; c++)
+    {
+        if(*c == '"' || *c == '\\')
+        {
+            out << '\\';
+        }
+        out << *c;
+    }
+}
+
+}
+
+Profiler* profilerCreate(unsigned int latency, std::size_t maxEvents)
+{
+    Profiler* profiler = new Profiler();
+    profiler->origin = std::chrono::steady_clock::now();
+    profiler->gpuTimers = GLAD_GL_ARB_timer_query != 0;
+    profiler->frames.resize(std::max(1u, latency));
+    profiler->maxEvents = maxEvents;
+    return profiler;
+}
+
+void profilerDelete(Profiler* profiler)
+{
+    for(detail::ProfilerFrame& frame : profiler->frames)
+    {
+        if(!frame.queries.empty())
+        {
+            glDeleteQueries(GLsizei(frame.queries.size()), frame.queries.data());
+        }
+    }
+    delete profiler;
+}
+
+void profilerFrameBegin(Profiler* profiler)
+{
+    detail::ProfilerFrame& frame = detail::currentFrame(profiler);
+    detail::resolve(profiler, frame);
+
+    frame.frame = profiler->frame;
+    if(profiler->gpuTimers)
+    {
+        /* offset from the GPU clock to ours, taken per frame so the clocks can't drift apart */
+        GLint64 gpuNow = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+        frame.gpuOffset = detail::profilerNow(profiler) - double(gpuNow) / 1000.0;
+    }
+
+    profilerBegin(profiler, "frame");
+}
+
+void profilerFrameEnd(Profiler* profiler)
+{
+    profilerEnd(profiler);
+    profiler->frame++;
+}
+
+void profilerBegin(Profiler* profiler, const char* name)
+{
+    if(profiler == nullptr)
+    {
+        return;
+    }
+
+    int gpuScope = -1;
+    if(profiler->gpuTimers)
+    {
+        detail::ProfilerFrame& frame = detail::currentFrame(profiler);
+        detail::GpuScope scope;
+        scope.name = name;
+        scope.depth = (unsigned int) profiler->open.size();
+        glQueryCounter(detail::nextQuery(frame, scope.queryBegin), GL_TIMESTAMP);
+        gpuScope = int(frame.scopes.size());
+        frame.scopes.push_back(scope);
+        frame.pending = true;
+    }
+    profiler->open.push_back({name, detail::profilerNow(profiler), gpuScope});
+}
+
+void profilerEnd(Profiler* profiler)
+{
+    if(profiler == nullptr || profiler->open.empty())
+    {
+        return;
+    }
+
+    detail::OpenScope scope = profiler->open.back();
+    profiler->open.pop_back();
+
+    if(scope.gpuScope >= 0)
+    {
+        detail::ProfilerFrame& frame = detail::currentFrame(profiler);
+        glQueryCounter(detail::nextQuery(frame, frame.scopes[scope.gpuScope].queryEnd), GL_TIMESTAMP);
+    }
+
+    ProfilerEvent event;
+    event.name = scope.name;
+    event.start = scope.start;
+    event.duration = detail::profilerNow(profiler) - scope.start;
+    event.frame = profiler->frame;
+    event.depth = (unsigned int) profiler->open.size();
+    detail::record(profiler, event);
+}
+
+const std::vector<ProfilerEvent>& profilerEvents(const Profiler* profiler)
+{
+    return profiler->events;
+}
+
+std::string profilerSummary(const Profiler* profiler)
+{
+    std::ostringstream out;
+    char line[160];
+    for(const detail::ProfilerTotals& totals : profiler->totals)
+    {
+        std::snprintf(line, sizeof(line), "%-16s cpu %8.3f ms", totals.name, totals.cpuCount ? totals.cpu / totals.cpuCount / 1000.0 : 0.0);
+        out << line;
+        if(totals.gpuCount > 0)
+        {
+            std::snprintf(line, sizeof(line), "   gpu %8.3f ms", totals.gpu / totals.gpuCount / 1000.0);
+            out << line;
+        }
+        out << "   (" << totals.cpuCount << " samples)\n";
+    }
+    if(profiler->stalls > 0)
+    {
+        out << profiler->stalls << " frames waited for GPU timestamps, increase the latency\n";
+    }
+    return out.str();
+}
+
+void profilerWriteTrace(const Profiler* profiler, const std::string& filepath)
+{
+    std::ofstream file(filepath);
+    if(!file)
+    {
+        std::cerr << "[Profiler] could not open " << filepath << " for writing" << std::endl;
+        throw std::runtime_error("[Profiler] could not write " + filepath);
+    }
+
+    /* complete ("X") events, microseconds, one thread per timeline */
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+         << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n"
+         << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+    file.precision(3);
+    file << std::fixed;
+    for(const ProfilerEvent& event : profiler->events)
+    {
+        file << ",\n{\"name\":\"";
+        detail::writeEscaped(file, event.name);
+        file << "\",\"cat\":\"" << (event.gpu ? "gpu" : "cpu") << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << (event.gpu ? 2 : 1)
+             << ",\"ts\":" << event.start << ",\"dur\":" << event.duration << ",\"args\":{\"frame\":" << event.frame << "}}";
+    }
+    file << "\n]}\n";
+
+    if(!file)
+    {
+        std::cerr << "[Profiler] write to " << filepath << " failed" << std::endl;
+        throw std::runtime_error("[Profiler] could not write " + filepath);
+    }
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "base.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/* one measured scope, times in microseconds since profilerCreate() */
+struct ProfilerEvent
+{
+    const char* name = nullptr;
+    double start = 0.0;
+    double duration = 0.0;
+    unsigned int frame = 0;
+    unsigned int depth = 0;
+    bool gpu = false;
+};
+
+/* CPU events, ring of GPU timestamp queries and totals, created by profilerCreate() */
+struct Profiler;
+
+/**
+ * @brief Create a frame profiler. Every scope is timed on the CPU with a steady clock and on the GPU with a pair of
+ * GL_TIMESTAMP queries (if GL_ARB_timer_query is available). The queries of a frame are read back when its slot in the
+ * query ring is reused, so the GPU results arrive a few frames later without waiting for the GPU.
+ *
+ * @param latency Frames in flight before the GPU results of a frame are read, the ring has as many slots.
+ * @param maxEvents Events kept for profilerWriteTrace(), later events only count towards the totals.
+ *
+ * @return Profiler, has to be deleted with profilerDelete().
+ *
+ * usage:
+ *
+ *   Profiler* profiler = profilerCreate();
+ *   ... every frame
+ *   profilerFrameBegin(profiler);
+ *   {
+ *       ProfilerScope scope(profiler, "draw");
+ *       sceneDraw();
+ *   }
+ *   profilerFrameEnd(profiler);
+ *   ... at the end
+ *   profilerWriteTrace(profiler, "trace.json");
+ */
+Profiler* profilerCreate(unsigned int latency = 3, std::size_t maxEvents = std::size_t(1) << 20);
+
+/**
+ * @brief Delete the queries of the profiler, GPU results of the frames still in flight are dropped.
+ *
+ * @param profiler Profiler.
+ */
+void profilerDelete(Profiler* profiler);
+
+/**
+ * @brief Start a frame, itself measured as a "frame" scope. Reads back the GPU results of the frame that used the same
+ * slot of the query ring before, waiting only if the GPU is more than latency frames behind.
+ *
+ * @param profiler Profiler.
+ */
+void profilerFrameBegin(Profiler* profiler);
+
+/* end the "frame" scope, call it after swapping the buffers so the swap is part of the frame */
+void profilerFrameEnd(Profiler* profiler);
+
+/**
+ * @brief Begin a named scope, scopes can be nested and have to be closed with profilerEnd() in reverse order. Does
+ * nothing if profiler is nullptr, so instrumentation can stay in place with profiling disabled.
+ *
+ * @param profiler Profiler or nullptr.
+ * @param name Name of the scope, has to outlive the profiler (a string literal).
+ */
+void profilerBegin(Profiler* profiler, const char* name);
+
+/* end the innermost open scope, does nothing if profiler is nullptr */
+void profilerEnd(Profiler* profiler);
+
+/* measures the lifetime of the object as scope */
+struct ProfilerScope
+{
+    ProfilerScope(Profiler* profiler, const char* name) : profiler(profiler) { profilerBegin(profiler, name); }
+    ~ProfilerScope() { profilerEnd(profiler); }
+
+    ProfilerScope(const ProfilerScope&) = delete;
+    ProfilerScope& operator=(const ProfilerScope&) = delete;
+
+    Profiler* profiler;
+};
+
+/* recorded events, CPU events right after their scope ended, GPU events once read back */
+const std::vector<ProfilerEvent>& profilerEvents(const Profiler* profiler);
+
+/**
+ * @brief Average CPU and GPU time of every scope name over all recorded frames, one line per name.
+ *
+ * @param profiler Profiler.
+ *
+ * @return Summary text.
+ */
+std::string profilerSummary(const Profiler* profiler);
+
+/**
+ * @brief Write the recorded events as Chrome trace JSON, open it in chrome://tracing (about:tracing) or Perfetto. CPU
+ * and GPU scopes are shown as two threads, GPU times are shifted onto the CPU clock. Throws if the file can't be
+ * written.
+ *
+ * @param profiler Profiler.
+ * @param filepath Path of the .json file.
+ */
+void profilerWriteTrace(const Profiler* profiler, const std::string& filepath);
@@ -1,9 +1,16 @@
 #include "shader.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <stdexcept>
+#include <thread>
 
 namespace detail
 {
@@ -31,6 +38,22 @@ namespace detail
         }
     }
 
+    /* the #version directive has to stay the first line, so the header goes right after it */
+    std::string insertHeader(const std::string& source, const std::string& header)
+    {
+        if(header.empty())
+        {
+            return source;
+        }
+
+        std::size_t lineEnd = source.rfind("#version", 0) == 0 ? source.find('\n') : std::string::npos;
+        if(lineEnd == std::string::npos)
+        {
+            return header + "\n" + source;
+        }
+        return source.substr(0, lineEnd + 1) + header + "\n" + source.substr(lineEnd + 1);
+    }
+
     void link(GLuint handle)
     {
         glLinkProgram(handle);
@@ -57,10 +80,270 @@ namespace detail
             throw std::runtime_error((std::string("[Shader] ERROR link shaderprogram: \n") + programLog));
         }
     }
+
+    /* FNV-1a */
+    std::size_t hash(std::string_view name)
+    {
+        std::size_t h = 14695981039346656037ull;
+        for(char c : name)
+        {
+            h = (h ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        }
+        return h;
+    }
+
+    /* the first element of an array uniform is stored under the plain array name */
+    std::string_view uniformName(std::string_view name)
+    {
+        if(name.size() > 3 && name.substr(name.size() - 3) == "[0]")
+        {
+            name.remove_suffix(3);
+        }
+        return name;
+    }
+
+    void introspect(ShaderProgram& program)
+    {
+        GLint count = 0, maxLength = 0;
+        glGetProgramiv(program.id, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(program.id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+        std::string name(static_cast<std::size_t>(maxLength), '\0');
+        program._uniforms.clear();
+        program._uniforms.reserve(count);
+
+        for(GLint i = 0; i < count; ++i)
+        {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = GL_NONE;
+            glGetActiveUniform(program.id, i, maxLength, &length, &size, &type, &name[0]);
+
+            /* members of uniform blocks have no location */
+            GLint location = glGetUniformLocation(program.id, name.c_str());
+            if(location < 0)
+            {
+                continue;
+            }
+
+            program._uniforms.push_back({location, type, std::string(uniformName(std::string_view(name.data(), length)))});
+        }
+
+        std::sort(program._uniforms.begin(), program._uniforms.end(),
+                  [](const UniformInfo& a, const UniformInfo& b) { return a.name < b.name; });
+    }
+
+    GLint location(const ShaderProgram& program, std::string_view name)
+    {
+        std::string_view key = uniformName(name);
+        auto uniform = std::lower_bound(program._uniforms.begin(), program._uniforms.end(), key,
+                                        [](const UniformInfo& info, std::string_view k) { return info.name < k; });
+        if(uniform != program._uniforms.end() && uniform->name == key)
+        {
+            return uniform->location;
+        }
+
+        /* array elements other than the first are not in the table */
+        if(name.find('[') != std::string_view::npos)
+        {
+            GLint location = glGetUniformLocation(program.id, std::string(name).c_str());
+            if(location >= 0)
+            {
+                return location;
+            }
+        }
+
+        std::cerr << "[Shader] Couldn't set value for uniform " << name << std::endl;
+        std::cerr.flush();
+        throw std::runtime_error("[Shader] Couldn't set value for uniform " + std::string(name));
+    }
+
+    /* set before any program is created, only read afterwards (also by the asset upload thread) */
+    std::string cacheDirectory;
+    std::atomic<unsigned int> cacheHits{0};
+    std::atomic<unsigned int> cacheMisses{0};
+    std::atomic<unsigned int> cacheRejected{0};
+    std::atomic<unsigned int> cacheWriteFailed{0};
+
+    /* file layout: header followed by length bytes of the binary */
+    struct ProgramBinaryHeader
+    {
+        char magic[4];
+        std::uint32_t version;
+        std::uint64_t key;
+        std::uint32_t format;
+        std::uint32_t length;
+    };
+
+    constexpr char cacheMagic[4] = {'M', 'G', 'L', 'B'};
+    constexpr std::uint32_t cacheVersion = 1;
+
+    bool cacheEnabled()
+    {
+        if(cacheDirectory.empty() || !GLAD_GL_ARB_get_program_binary)
+        {
+            return false;
+        }
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        return formats > 0;
+    }
+
+    std::string glString(GLenum name)
+    {
+        const GLubyte* value = glGetString(name);
+        return value != nullptr ? reinterpret_cast<const char*>(value) : "";
+    }
+
+    /* a driver update changes the version string, so binaries of the old driver are never even tried */
+    std::uint64_t cacheKey(const std::string& vertexSource, const std::string& fragmentSource)
+    {
+        std::string key = vertexSource;
+        key += '\0';
+        key += fragmentSource;
+        key += '\0';
+        key += glString(GL_VENDOR);
+        key += '\0';
+        key += glString(GL_RENDERER);
+        key += '\0';
+        key += glString(GL_VERSION);
+        return static_cast<std::uint64_t>(hash(key));
+    }
+
+    std::string cachePath(std::uint64_t key)
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+        return (std::filesystem::path(cacheDirectory) / name).string();
+    }
+
+    bool binaryFormatSupported(GLenum format)
+    {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &count);
+        std::vector<GLint> formats(static_cast<std::size_t>(count));
+        glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data());
+        for(GLint supported : formats)
+        {
+            if(static_cast<GLenum>(supported) == format)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /* false if there is no entry or the driver rejects it, the program has to be recreated then */
+    bool cacheLoad(GLuint program, const std::string& path, std::uint64_t key)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if(!file.is_open())
+        {
+            return false;
+        }
+        const std::streamoff size = file.tellg();
+        file.seekg(0);
+
+        /* the length is only trusted if it matches the file, a truncated or corrupt entry must not allocate */
+        ProgramBinaryHeader header{};
+        std::vector<char> binary;
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if(file && std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) == 0 && header.version == cacheVersion
+           && header.key == key && std::streamoff(header.length) == size - std::streamoff(sizeof(header))
+           && binaryFormatSupported(header.format))
+        {
+            binary.resize(header.length);
+            file.read(binary.data(), header.length);
+        }
+        if(!file || binary.empty())
+        {
+            cacheRejected++;
+            return false;
+        }
+
+        glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+        GLint result = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &result);
+        if(result == GL_FALSE)
+        {
+            cacheRejected++;
+            return false;
+        }
+        return true;
+    }
+
+    /* written to a temporary file and renamed, so readers never see a partly written entry */
+    void cacheStore(GLuint program, const std::string& path, std::uint64_t key)
+    {
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+
+        ProgramBinaryHeader header{};
+        std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+        header.version = cacheVersion;
+        header.key = key;
+
+        std::vector<char> binary(static_cast<std::size_t>(std::max(length, 0)));
+        GLenum format = GL_NONE;
+        if(length > 0)
+        {
+            glGetProgramBinary(program, length, &length, &format, binary.data());
+        }
+        if(length <= 0)
+        {
+            cacheWriteFailed++;
+            return;
+        }
+        header.format = format;
+        header.length = static_cast<std::uint32_t>(length);
+
+        std::string temporary = path + "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(binary.data(), header.length);
+            if(!file)
+            {
+                std::cerr << "[Shader] Couldn't write program binary " << temporary << std::endl;
+                cacheWriteFailed++;
+                return;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporary, path, error);
+        if(error)
+        {
+            std::cerr << "[Shader] Couldn't write program binary " << path << ": " << error.message() << std::endl;
+            std::filesystem::remove(temporary, error);
+            cacheWriteFailed++;
+        }
+    }
 }
 
-ShaderProgram shaderCreate(const std::string &vertexSource, const std::string &fragmentSource)
+ShaderProgram shaderCreate(const std::string &vertexSource, const std::string &fragmentSource, const std::string &vertexHeader)
 {
+    const std::string vertexFullSource = detail::insertHeader(vertexSource, vertexHeader);
+
+    /* a cached binary replaces compile and link, the program has no shader objects then */
+    std::string cachePath;
+    std::uint64_t cacheKey = 0;
+    if(detail::cacheEnabled())
+    {
+        cacheKey = detail::cacheKey(vertexFullSource, fragmentSource);
+        cachePath = detail::cachePath(cacheKey);
+
+        ShaderProgram program{glCreateProgram()};
+        if(program.id && detail::cacheLoad(program.id, cachePath, cacheKey))
+        {
+            detail::cacheHits++;
+            detail::introspect(program);
+            return program;
+        }
+        glDeleteProgram(program.id);
+        detail::cacheMisses++;
+    }
+
     ShaderProgram program{glCreateProgram(), glCreateShader(GL_VERTEX_SHADER), glCreateShader(GL_FRAGMENT_SHADER)};
 
     if(!program._vertexID || !program._fragmentID || !program.id)
@@ -70,18 +353,62 @@ ShaderProgram shaderCreate(const std::string &vertexSource, const std::string &f
         throw std::runtime_error("[Shader] Couldn't create shader program!");
     }
 
-    detail::compile(program._vertexID, vertexSource.c_str(), vertexSource.size());
+    detail::compile(program._vertexID, vertexFullSource.c_str(), vertexFullSource.size());
     glAttachShader(program.id, program._vertexID);
 
     detail::compile(program._fragmentID, fragmentSource.c_str(), fragmentSource.size());
     glAttachShader(program.id, program._fragmentID);
 
+    if(!cachePath.empty())
+    {
+        glProgramParameteri(program.id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     detail::link(program.id);
+    if(!cachePath.empty())
+    {
+        detail::cacheStore(program.id, cachePath, cacheKey);
+    }
+    detail::introspect(program);
 
     return program;
 }
 
-ShaderProgram shaderLoad(const std::string &vertexPath, const std::string &fragmentPath)
+void shaderCacheSetDirectory(const std::string &directory)
+{
+    detail::cacheDirectory.clear();
+    if(directory.empty())
+    {
+        return;
+    }
+
+    /* the cache only saves time, without it programs are compiled as before */
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if(error)
+    {
+        std::cerr << "[Shader] Couldn't create shader cache directory " << directory << ": " << error.message() << std::endl;
+        return;
+    }
+    detail::cacheDirectory = directory;
+}
+
+ShaderCacheStats shaderCacheStats()
+{
+    ShaderCacheStats stats;
+    stats.hits = detail::cacheHits.load();
+    stats.misses = detail::cacheMisses.load();
+    stats.rejected = detail::cacheRejected.load();
+    stats.writeFailed = detail::cacheWriteFailed.load();
+    return stats;
+}
+
+const std::string toString(const ShaderCacheStats &stats)
+{
+    return std::to_string(stats.hits) + " hits, " + std::to_string(stats.misses) + " misses, "
+        + std::to_string(stats.rejected) + " rejected, " + std::to_string(stats.writeFailed) + " write failures";
+}
+
+ShaderProgram shaderLoad(const std::string &vertexPath, const std::string &fragmentPath, const std::string &vertexHeader)
 {
     std::ifstream vertexFile(vertexPath);
     std::ifstream fragmentFile(fragmentPath);
@@ -106,39 +433,59 @@ ShaderProgram shaderLoad(const std::string &vertexPath, const std::string &fragm
     std::stringstream fragmentSourceBuffer;
     fragmentSourceBuffer << fragmentFile.rdbuf();
 
-    return shaderCreate(vertexSourceBuffer.str(), fragmentSourceBuffer.str());
+    return shaderCreate(vertexSourceBuffer.str(), fragmentSourceBuffer.str(), vertexHeader);
 }
 
 void shaderDelete(const ShaderProgram &program)
 {
-    glDetachShader(program.id, program._vertexID);
-    glDetachShader(program.id, program._fragmentID);
-    glDeleteShader(program._vertexID);
-    glDeleteShader(program._fragmentID);
+    /* programs loaded from the binary cache have no shader objects */
+    if(program._vertexID != 0)
+    {
+        glDetachShader(program.id, program._vertexID);
+        glDeleteShader(program._vertexID);
+    }
+    if(program._fragmentID != 0)
+    {
+        glDetachShader(program.id, program._fragmentID);
+        glDeleteShader(program._fragmentID);
+    }
 
     glDeleteProgram(program.id);
 }
 
-void shaderUniform(ShaderProgram &shader, const std::string &name, const Matrix4D &value)
+UniformHandle shaderUniformHandle(const ShaderProgram &shader, std::string_view name)
 {
-    GLint index = glGetUniformLocation(shader.id, name.c_str());
-    if(index < 0)
-    {
-        std::cerr << "[Shader] Couldn't set value for uniform " << name << std::endl;
-        std::cerr.flush();
-        throw std::runtime_error("[Shader] Couldn't set value for uniform " + name);
-    }
-    glUniformMatrix4fv(index, 1, GL_FALSE, value.ptr());
+    return UniformHandle{detail::location(shader, name)};
+}
+
+void shaderUniform(ShaderProgram &shader, std::string_view name, const Matrix4D &value)
+{
+    glUniformMatrix4fv(detail::location(shader, name), 1, GL_FALSE, value.ptr());
+}
+
+void shaderUniform(ShaderProgram &shader, std::string_view name, int value)
+{
+    glUniform1i(detail::location(shader, name), value);
+}
+
+void shaderUniform(ShaderProgram &shader, UniformHandle uniform, const Matrix4D &value)
+{
+    glUniformMatrix4fv(uniform.location, 1, GL_FALSE, value.ptr());
 }
 
-void shaderUniform(ShaderProgram &shader, const std::string &name, int value)
+void shaderUniform(ShaderProgram &shader, UniformHandle uniform, int value)
 {
-    GLint index = glGetUniformLocation(shader.id, name.c_str());
-    if(index < 0)
+    glUniform1i(uniform.location, value);
+}
+
+void shaderUniformBlock(ShaderProgram &shader, std::string_view blockName, GLuint bindingPoint)
+{
+    GLuint index = glGetUniformBlockIndex(shader.id, std::string(blockName).c_str());
+    if(index == GL_INVALID_INDEX)
     {
-        std::cerr << "[Shader] Couldn't set value for uniform " << name << std::endl;
+        std::cerr << "[Shader] Couldn't find uniform block " << blockName << std::endl;
         std::cerr.flush();
-        throw std::runtime_error("[Shader] Couldn't set value for uniform " + name);
+        throw std::runtime_error("[Shader] Couldn't find uniform block " + std::string(blockName));
     }
-    glUniform1i(index, value);
+    glUniformBlockBinding(shader.id, index, bindingPoint);
 }
@@ -2,11 +2,30 @@
 
 #include "base.h"
 
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* active uniform of a linked shader program, collected once after linking and kept sorted by name */
+struct UniformInfo
+{
+    GLint location = -1;
+    GLenum type = GL_NONE;
+    std::string name;
+};
+
+/* location of a uniform in one specific shader program, see shaderUniformHandle() */
+struct UniformHandle
+{
+    GLint location = -1;
+};
+
 struct ShaderProgram
 {
     GLuint id = 0;
     GLuint _vertexID = 0;
     GLuint _fragmentID = 0;
+    std::vector<UniformInfo> _uniforms;
 };
 
 /**
@@ -14,20 +33,51 @@ struct ShaderProgram
  *
  * @param vertexPath Path to vertex shader file.
  * @param fragmentPath Path to fragment shader file.
+ * @param vertexHeader Source inserted after the #version line of the vertex shader (e.g. vertexLayoutShaderHeader()).
  *
  * @return Shader program.
  */
-ShaderProgram shaderLoad(const std::string& vertexPath, const std::string& fragmentPath);
+ShaderProgram shaderLoad(const std::string& vertexPath, const std::string& fragmentPath, const std::string& vertexHeader = "");
 
 /**
  * @brief Function to compile and link vertex and fragement source strings to create shader program.
  *
  * @param vertexSource Source string holding vertex shader code.
  * @param fragmentSource Source string holding fragment shader code.
+ * @param vertexHeader Source inserted after the #version line of the vertex shader.
  *
  * @return Shader program.
  */
-ShaderProgram shaderCreate(const std::string& vertexSource, const std::string& fragmentSource);
+ShaderProgram shaderCreate(const std::string& vertexSource, const std::string& fragmentSource, const std::string& vertexHeader = "");
+
+/* counted since the start of the program, a compile is a miss and a rejected entry is also a miss */
+struct ShaderCacheStats
+{
+    unsigned int hits = 0;
+    unsigned int misses = 0;
+    unsigned int rejected = 0;
+    unsigned int writeFailed = 0;
+};
+
+/**
+ * @brief Enable the on-disk cache of linked program binaries (GL_ARB_get_program_binary). shaderCreate() and
+ * shaderLoad() then look for a binary keyed by a hash of the full sources (vertex header included) and the GL vendor,
+ * renderer and version strings before compiling. A missing, foreign or rejected binary falls back to compiling from
+ * source and the cache entry is rewritten. Has to be called before programs are created on any thread, does nothing
+ * if the driver supports no binary formats.
+ *
+ * @param directory Directory of the cache files, created if it doesn't exist. An empty string disables the cache.
+ *
+ * usage:
+ *
+ *   shaderCacheSetDirectory("shader_cache");
+ *   ShaderProgram shader = shaderLoad("shader/default.vert", "shader/default.frag");
+ */
+void shaderCacheSetDirectory(const std::string& directory);
+
+ShaderCacheStats shaderCacheStats();
+
+const std::string toString(const ShaderCacheStats& stats);
 
 /**
  * @brief Cleanup and delete all shaders of a shader program and the program itself. Has to be called for each shader program after it is not used anymore.
@@ -36,6 +86,18 @@ ShaderProgram shaderCreate(const std::string& vertexSource, const std::string& f
  */
 void shaderDelete(const ShaderProgram& program);
 
+/**
+ * @brief Look up the handle of an active uniform. The uniforms are introspected once when the program is linked and
+ * looked up with a binary search, so this does not query the driver. Only array elements other than the first
+ * ("lights[3]") are resolved with glGetUniformLocation. Resolve handles once after loading and use them in the draw loop.
+ *
+ * @param shader Shader program.
+ * @param name Uniform name (array uniforms can be given with or without the trailing [0]).
+ *
+ * @return Handle of the uniform.
+ */
+UniformHandle shaderUniformHandle(const ShaderProgram& shader, std::string_view name);
+
 /**
  * @brief Function to set uniform in shader program.
  *
@@ -43,7 +105,7 @@ void shaderDelete(const ShaderProgram& program);
  * @param name Uniform naem.
  * @param value Value to which the uniform should be set.
  */
-void shaderUniform(ShaderProgram& shader, const std::string& name, const Matrix4D& value);
+void shaderUniform(ShaderProgram& shader, std::string_view name, const Matrix4D& value);
 
 /**
  * @brief Function to set uniform in shader program.
@@ -52,4 +114,31 @@ void shaderUniform(ShaderProgram& shader, const std::string& name, const Matrix4
  * @param name Uniform naem.
  * @param value Value to which the uniform should be set.
  */
-void shaderUniform(ShaderProgram& shader, const std::string& name, int value);
+void shaderUniform(ShaderProgram& shader, std::string_view name, int value);
+
+/**
+ * @brief Function to set uniform in shader program without any name lookup.
+ *
+ * @param shader Shader program (has to be in use).
+ * @param uniform Handle obtained from shaderUniformHandle() for this program.
+ * @param value Value to which the uniform should be set.
+ */
+void shaderUniform(ShaderProgram& shader, UniformHandle uniform, const Matrix4D& value);
+
+/**
+ * @brief Function to set uniform in shader program without any name lookup.
+ *
+ * @param shader Shader program (has to be in use).
+ * @param uniform Handle obtained from shaderUniformHandle() for this program.
+ * @param value Value to which the uniform should be set.
+ */
+void shaderUniform(ShaderProgram& shader, UniformHandle uniform, int value);
+
+/**
+ * @brief Connect a uniform block of the shader program to a uniform buffer binding point.
+ *
+ * @param shader Shader program.
+ * @param blockName Name of the uniform block.
+ * @param bindingPoint Binding point the uniform buffer is bound to (see eBlockIdx in uniformbuffer.h).
+ */
+void shaderUniformBlock(ShaderProgram& shader, std::string_view blockName, GLuint bindingPoint);
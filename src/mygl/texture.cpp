@@ -0,0 +1,30 @@
+#include "texture.h"
+
+Texture textureCreate(int width, int height, const unsigned char* rgba, bool mipmaps)
+{
+    Texture texture{0, width, height};
+
+    glGenTextures(1, &texture.id);
+    glBindTexture(GL_TEXTURE_2D, texture.id);
+
+    /* rows of RGBA8 are always 4-byte aligned, but the default would break for other formats */
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    if(mipmaps && rgba)
+    {
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    glCheckError();
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return texture;
+}
+
+void textureDelete(const Texture& texture)
+{
+    glDeleteTextures(1, &texture.id);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "base.h"
+
+struct Texture
+{
+    GLuint id = 0;
+    int width = 0;
+    int height = 0;
+};
+
+/**
+ * @brief Create a 2D RGBA8 texture with linear filtering and repeat wrapping.
+ *
+ * @param width Width in pixels.
+ * @param height Height in pixels.
+ * @param rgba Pixel data, rows bottom to top (OpenGL convention), or nullptr to only allocate the storage.
+ * @param mipmaps Use trilinear filtering, the mip levels are generated from the data (call glGenerateMipmap
+ * yourself if the data is uploaded later).
+ *
+ * @return Texture.
+ *
+ * usage:
+ *
+ *   Texture texture = textureCreate(width, height, pixels);
+ *   glActiveTexture(GL_TEXTURE0);
+ *   glBindTexture(GL_TEXTURE_2D, texture.id);
+ */
+Texture textureCreate(int width, int height, const unsigned char* rgba, bool mipmaps = true);
+
+/**
+ * @brief Delete the OpenGL texture. Has to be called for each texture after it is not used anymore.
+ *
+ * @param texture Texture to delete.
+ */
+void textureDelete(const Texture& texture);
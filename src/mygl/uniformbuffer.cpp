@@ -0,0 +1,129 @@
+#include "uniformbuffer.h"
+
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+UniformBuffer uniformBufferCreate(GLsizeiptr size)
+{
+    GLuint ubo = 0;
+
+    glGenBuffers(1, &ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+    glCheckError();
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    return UniformBuffer{ubo, size};
+}
+
+void uniformBufferUpdate(const UniformBuffer& buffer, const void* data, GLsizeiptr size, GLintptr offset)
+{
+    assert(offset + size <= buffer.size);
+
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer.ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void uniformBufferBind(const UniformBuffer& buffer, GLuint bindingPoint)
+{
+    glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, buffer.ubo);
+}
+
+void uniformBufferDelete(const UniformBuffer& buffer)
+{
+    glDeleteBuffers(1, &buffer.ubo);
+}
+
+UniformRing uniformRingCreate(GLsizeiptr elementSize, unsigned int capacity, unsigned int frames)
+{
+    GLint alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+
+    UniformRing ring;
+    ring.elementSize = elementSize;
+    ring.stride = (elementSize + alignment - 1) / alignment * alignment;
+    ring.capacity = capacity;
+    ring.frames = frames;
+    ring.staging.resize(ring.stride * capacity);
+    ring.fences.resize(frames, nullptr);
+
+    glGenBuffers(1, &ring.ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, ring.ubo);
+    glBufferData(GL_UNIFORM_BUFFER, ring.stride * capacity * frames, nullptr, GL_DYNAMIC_DRAW);
+    glCheckError();
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    return ring;
+}
+
+void uniformRingBegin(UniformRing& ring)
+{
+    ring.frame = (ring.frame + 1) % ring.frames;
+    ring.count = 0;
+    fenceWait(ring.fences[ring.frame]);
+}
+
+void uniformRingEnd(UniformRing& ring)
+{
+    if(ring.fences[ring.frame] != nullptr)
+    {
+        glDeleteSync(ring.fences[ring.frame]);
+    }
+    ring.fences[ring.frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+unsigned int uniformRingPush(UniformRing& ring, const void* data)
+{
+    if(ring.count >= ring.capacity)
+    {
+        std::cerr << "[UniformRing] more than " << ring.capacity << " slots pushed in one frame" << std::endl;
+        throw std::runtime_error("[UniformRing] capacity exceeded");
+    }
+
+    std::memcpy(ring.staging.data() + ring.count * ring.stride, data, ring.elementSize);
+    return ring.count++;
+}
+
+void uniformRingUpload(UniformRing& ring)
+{
+    if(ring.count == 0)
+    {
+        return;
+    }
+
+    /* the fence waited for in uniformRingBegin() guarantees that the GPU is done with the region */
+    glBindBuffer(GL_UNIFORM_BUFFER, ring.ubo);
+    void* region = glMapBufferRange(GL_UNIFORM_BUFFER, GLintptr(ring.frame) * ring.capacity * ring.stride, GLsizeiptr(ring.count) * ring.stride,
+                                    GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+    std::memcpy(region, ring.staging.data(), ring.count * ring.stride);
+    glUnmapBuffer(GL_UNIFORM_BUFFER);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void uniformRingBind(const UniformRing& ring, GLuint bindingPoint, unsigned int slot)
+{
+    if(slot >= ring.count)
+    {
+        std::cerr << "[UniformRing] slot " << slot << " was not pushed in this frame (" << ring.count << " slots)" << std::endl;
+        throw std::runtime_error("[UniformRing] invalid slot");
+    }
+
+    GLintptr offset = (GLintptr(ring.frame) * ring.capacity + slot) * ring.stride;
+    glBindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, ring.ubo, offset, ring.elementSize);
+}
+
+void uniformRingDelete(UniformRing& ring)
+{
+    for(GLsync& fence : ring.fences)
+    {
+        if(fence != nullptr)
+        {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    glDeleteBuffers(1, &ring.ubo);
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "base.h"
+
+#include <vector>
+
+/* binding points of the uniform blocks (match the blocks in default_ubo.vert) */
+enum eBlockIdx { CameraBinding = 0, ObjectBinding = 1 };
+
+/* std140 layout of the CameraBlock uniform block, written once per frame */
+struct alignas(16) CameraBlock
+{
+    Matrix4D proj;
+    Matrix4D view;
+    Matrix4D viewProj;
+    Vector4D position;
+};
+
+/* std140 layout of the ObjectBlock uniform block, one per draw */
+struct alignas(16) ObjectBlock
+{
+    Matrix4D model;
+};
+
+struct UniformBuffer
+{
+    GLuint ubo = 0;
+    GLsizeiptr size = 0;
+};
+
+/* uniform buffer holding one slot per draw for several frames in flight */
+struct UniformRing
+{
+    GLuint ubo = 0;
+    GLsizeiptr elementSize = 0;
+    GLsizeiptr stride = 0;
+    unsigned int capacity = 0;
+    unsigned int frames = 0;
+
+    unsigned int frame = 0;
+    unsigned int count = 0;
+    std::vector<unsigned char> staging;
+
+    /* one fence per region, set by uniformRingEnd() after the last draw that read the region */
+    std::vector<GLsync> fences;
+};
+
+/**
+ * @brief Create a uniform buffer object of a fixed size.
+ *
+ * @param size Size of the buffer in bytes.
+ *
+ * @return Uniform buffer.
+ */
+UniformBuffer uniformBufferCreate(GLsizeiptr size);
+
+/**
+ * @brief Upload data into a uniform buffer.
+ *
+ * @param buffer Uniform buffer.
+ * @param data Data to upload.
+ * @param size Size of the data in bytes.
+ * @param offset Byte offset into the buffer.
+ */
+void uniformBufferUpdate(const UniformBuffer& buffer, const void* data, GLsizeiptr size, GLintptr offset = 0);
+
+/**
+ * @brief Bind the whole uniform buffer to a uniform block binding point.
+ *
+ * @param buffer Uniform buffer.
+ * @param bindingPoint Binding point (see eBlockIdx).
+ */
+void uniformBufferBind(const UniformBuffer& buffer, GLuint bindingPoint);
+
+/**
+ * @brief Delete the OpenGL buffer of a uniform buffer.
+ *
+ * @param buffer Uniform buffer to delete.
+ */
+void uniformBufferDelete(const UniformBuffer& buffer);
+
+/**
+ * @brief Create a ring of uniform slots. Each slot is padded to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT so that it can be
+ * selected with glBindBufferRange, and every frame writes into its own region of the buffer. A fence per region keeps
+ * the CPU from overwriting slots the GPU still reads, so the ring has to be sized for all draws of a frame.
+ *
+ * @param elementSize Size of one slot (e.g. sizeof(ObjectBlock)).
+ * @param capacity Maximal number of slots per frame (all draws of a frame).
+ * @param frames Number of frames in flight the buffer is partitioned into.
+ *
+ * @return Uniform ring.
+ *
+ * usage:
+ *
+ *   uniformRingBegin(ring);
+ *   unsigned int slot = uniformRingPush(ring, ObjectBlock{model});
+ *   ...
+ *   uniformRingUpload(ring);
+ *   uniformRingBind(ring, eBlockIdx::ObjectBinding, slot);
+ *   glDrawElements(...);
+ *   ...
+ *   uniformRingEnd(ring);
+ */
+UniformRing uniformRingCreate(GLsizeiptr elementSize, unsigned int capacity, unsigned int frames = 3);
+
+/**
+ * @brief Start a new frame: advances to the next region of the ring and discards all pushed slots. Waits for the fence
+ * of the region, which only blocks if the GPU is more than frames - 1 frames behind. Call it once per frame.
+ *
+ * @param ring Uniform ring.
+ */
+void uniformRingBegin(UniformRing& ring);
+
+/**
+ * @brief Fence the region of the current frame, call it after the last draw that binds a slot of this frame.
+ *
+ * @param ring Uniform ring.
+ */
+void uniformRingEnd(UniformRing& ring);
+
+/**
+ * @brief Copy the data of one draw into the next slot of the current frame (CPU side only).
+ *
+ * @param ring Uniform ring (throws if all slots of the frame are used).
+ * @param data Data of size elementSize.
+ *
+ * @return Slot index to pass to uniformRingBind().
+ */
+unsigned int uniformRingPush(UniformRing& ring, const void* data);
+
+template<typename T>
+unsigned int uniformRingPush(UniformRing& ring, const T& value)
+{
+    return uniformRingPush(ring, static_cast<const void*>(&value));
+}
+
+/**
+ * @brief Upload all slots pushed in this frame with a single unsynchronized write into the region of the frame.
+ *
+ * @param ring Uniform ring.
+ */
+void uniformRingUpload(UniformRing& ring);
+
+/**
+ * @brief Bind one slot of the current frame to a uniform block binding point.
+ *
+ * @param ring Uniform ring.
+ * @param bindingPoint Binding point (see eBlockIdx).
+ * @param slot Slot index returned by uniformRingPush() in this frame (throws otherwise).
+ */
+void uniformRingBind(const UniformRing& ring, GLuint bindingPoint, unsigned int slot);
+
+/**
+ * @brief Delete the OpenGL buffer and the fences of a uniform ring.
+ *
+ * @param ring Uniform ring to delete.
+ */
+void uniformRingDelete(UniformRing& ring);
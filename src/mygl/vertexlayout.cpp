@@ -0,0 +1,299 @@
+#include "vertexlayout.h"
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace detail
+{
+
+GLuint formatSize(eAttribFormat format)
+{
+    switch(format)
+    {
+        case PositionFloat3:    return 12;
+        case PositionHalf4:     return 8;
+        case PositionSnorm16x4: return 8;
+        case ColorFloat4:       return 16;
+        case ColorUnorm8x4:     return 4;
+        case NormalFloat3:      return 12;
+        case NormalOct16x2:     return 4;
+    }
+    return 0;
+}
+
+eDataIdx formatLocation(eAttribFormat format)
+{
+    switch(format)
+    {
+        case PositionFloat3:
+        case PositionHalf4:
+        case PositionSnorm16x4: return eDataIdx::Position;
+        case ColorFloat4:
+        case ColorUnorm8x4:     return eDataIdx::Color;
+        case NormalFloat3:
+        case NormalOct16x2:     return eDataIdx::Normal;
+    }
+    return eDataIdx::Position;
+}
+
+/* round to nearest, values are in [-1, 1] for positions, so overflow and denormals hardly matter */
+uint16_t floatToHalf(float f)
+{
+    uint32_t x;
+    std::memcpy(&x, &f, sizeof(x));
+
+    uint32_t sign = (x >> 16) & 0x8000;
+    int32_t exponent = int32_t((x >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = x & 0x7fffff;
+
+    if(((x >> 23) & 0xff) == 0xff)
+    {
+        return uint16_t(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+    }
+    if(exponent >= 31)
+    {
+        return uint16_t(sign | 0x7c00);
+    }
+    if(exponent <= 0)
+    {
+        if(exponent < -10)
+        {
+            return uint16_t(sign);
+        }
+        mantissa |= 0x800000;
+        uint32_t shift = uint32_t(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        half += (mantissa >> (shift - 1)) & 1;
+        return uint16_t(sign | half);
+    }
+
+    /* a carry out of the mantissa correctly bumps the exponent */
+    uint32_t half = sign | (uint32_t(exponent) << 10) | (mantissa >> 13);
+    half += (mantissa >> 12) & 1;
+    return uint16_t(half);
+}
+
+int16_t floatToSnorm16(float f)
+{
+    return int16_t(std::lround(std::clamp(f, -1.0f, 1.0f) * 32767.0f));
+}
+
+uint8_t floatToUnorm8(float f)
+{
+    return uint8_t(std::lround(std::clamp(f, 0.0f, 1.0f) * 255.0f));
+}
+
+/* octahedral projection of a unit vector onto [-1, 1]^2 (Meyer et al.) */
+Vector2D octEncode(const Vector3D& n)
+{
+    float l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    if(l1 == 0.0f)
+    {
+        return Vector2D(0.0f, 0.0f);
+    }
+
+    Vector2D p(n.x / l1, n.y / l1);
+    if(n.z < 0.0f)
+    {
+        p = Vector2D((1.0f - std::abs(p.y)) * (p.x >= 0.0f ? 1.0f : -1.0f),
+                     (1.0f - std::abs(p.x)) * (p.y >= 0.0f ? 1.0f : -1.0f));
+    }
+    return p;
+}
+
+/* position relative to the box in [-1, 1], flat axes map to 0 */
+Vector3D quantizationSpace(const Vector3D& p, const AABB& bounds)
+{
+    Vector3D c = bounds.center();
+    Vector3D e = bounds.extents();
+    return Vector3D(e.x > 0.0f ? (p.x - c.x) / e.x : 0.0f,
+                    e.y > 0.0f ? (p.y - c.y) / e.y : 0.0f,
+                    e.z > 0.0f ? (p.z - c.z) / e.z : 0.0f);
+}
+
+template<typename T, std::size_t N>
+void store(unsigned char* dst, const T (&values)[N])
+{
+    std::memcpy(dst, values, sizeof(values));
+}
+
+}
+
+VertexLayout vertexLayoutCreate(std::initializer_list<eAttribFormat> formats)
+{
+    VertexLayout layout;
+    for(eAttribFormat format : formats)
+    {
+        for(const VertexAttribute& attribute : layout.attributes)
+        {
+            if(detail::formatLocation(attribute.format) == detail::formatLocation(format))
+            {
+                std::cerr << "[VertexLayout] attribute location " << detail::formatLocation(format) << " used twice" << std::endl;
+                throw std::runtime_error("[VertexLayout] attribute used twice");
+            }
+        }
+
+        layout.attributes.push_back({format, GLuint(layout.stride)});
+        layout.stride += detail::formatSize(format);
+    }
+    return layout;
+}
+
+GLuint vertexAttribSize(eAttribFormat format)
+{
+    return detail::formatSize(format);
+}
+
+GLuint vertexAttribLocation(eAttribFormat format)
+{
+    return detail::formatLocation(format);
+}
+
+bool vertexLayoutQuantized(const VertexLayout& layout)
+{
+    for(const VertexAttribute& attribute : layout.attributes)
+    {
+        if(attribute.format == PositionHalf4 || attribute.format == PositionSnorm16x4)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+Matrix4D vertexLayoutDequantization(const VertexLayout& layout, const AABB& bounds)
+{
+    if(!vertexLayoutQuantized(layout) || bounds.empty())
+    {
+        return Matrix4D::identity();
+    }
+
+    Vector3D e = bounds.extents();
+    return affineMultiply(Matrix4D::translation(bounds.center()), Matrix4D::scale(e.x, e.y, e.z));
+}
+
+std::vector<unsigned char> vertexLayoutEncode(const VertexLayout& layout, const AABB& bounds, const std::vector<Vertex>& vertices,
+                                              const std::vector<Vector3D>& normals)
+{
+    std::vector<unsigned char> data(std::size_t(layout.stride) * vertices.size());
+
+    for(std::size_t i = 0; i < vertices.size(); i++)
+    {
+        unsigned char* vertex = data.data() + i * layout.stride;
+        const Vector3D& p = vertices[i].pos;
+        const Vector4D& c = vertices[i].color;
+        const Vector3D n = i < normals.size() ? normals[i] : Vector3D(0.0f, 1.0f, 0.0f);
+
+        for(const VertexAttribute& attribute : layout.attributes)
+        {
+            unsigned char* dst = vertex + attribute.offset;
+            switch(attribute.format)
+            {
+                case PositionFloat3:
+                    detail::store(dst, {p.x, p.y, p.z});
+                    break;
+                case PositionHalf4:
+                {
+                    Vector3D q = detail::quantizationSpace(p, bounds);
+                    detail::store(dst, {detail::floatToHalf(q.x), detail::floatToHalf(q.y), detail::floatToHalf(q.z), uint16_t(0)});
+                    break;
+                }
+                case PositionSnorm16x4:
+                {
+                    Vector3D q = detail::quantizationSpace(p, bounds);
+                    detail::store(dst, {detail::floatToSnorm16(q.x), detail::floatToSnorm16(q.y), detail::floatToSnorm16(q.z), int16_t(0)});
+                    break;
+                }
+                case ColorFloat4:
+                    detail::store(dst, {c.x, c.y, c.z, c.w});
+                    break;
+                case ColorUnorm8x4:
+                    detail::store(dst, {detail::floatToUnorm8(c.x), detail::floatToUnorm8(c.y), detail::floatToUnorm8(c.z), detail::floatToUnorm8(c.w)});
+                    break;
+                case NormalFloat3:
+                    detail::store(dst, {n.x, n.y, n.z});
+                    break;
+                case NormalOct16x2:
+                {
+                    Vector2D o = detail::octEncode(n);
+                    detail::store(dst, {detail::floatToSnorm16(o.x), detail::floatToSnorm16(o.y)});
+                    break;
+                }
+            }
+        }
+    }
+
+    return data;
+}
+
+void vertexLayoutSetup(const VertexLayout& layout)
+{
+    for(const VertexAttribute& attribute : layout.attributes)
+    {
+        GLuint location = detail::formatLocation(attribute.format);
+        const void* offset = (const void*) std::uintptr_t(attribute.offset);
+
+        glEnableVertexAttribArray(location);
+        switch(attribute.format)
+        {
+            case PositionFloat3:
+            case NormalFloat3:      glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, layout.stride, offset); break;
+            case ColorFloat4:       glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, layout.stride, offset); break;
+            case PositionHalf4:     glVertexAttribPointer(location, 4, GL_HALF_FLOAT, GL_FALSE, layout.stride, offset); break;
+            case ColorUnorm8x4:     glVertexAttribPointer(location, 4, GL_UNSIGNED_BYTE, GL_TRUE, layout.stride, offset); break;
+            case PositionSnorm16x4: glVertexAttribIPointer(location, 4, GL_SHORT, layout.stride, offset); break;
+            case NormalOct16x2:     glVertexAttribIPointer(location, 2, GL_SHORT, layout.stride, offset); break;
+        }
+    }
+    glCheckError();
+}
+
+std::string vertexLayoutShaderHeader(const VertexLayout& layout)
+{
+    std::string position = "vec3 vertexPosition() { return vec3(0.0); }\n";
+    std::string color = "vec4 vertexColor() { return vec4(1.0); }\n";
+    std::string normal = "vec3 vertexNormal() { return vec3(0.0, 1.0, 0.0); }\n";
+
+    for(const VertexAttribute& attribute : layout.attributes)
+    {
+        std::string location = "layout(location = " + std::to_string(detail::formatLocation(attribute.format)) + ") in ";
+        switch(attribute.format)
+        {
+            case PositionFloat3:
+                position = location + "vec3 aPosition;\n"
+                           "vec3 vertexPosition() { return aPosition; }\n";
+                break;
+            case PositionHalf4:
+                position = location + "vec4 aPosition;\n"
+                           "vec3 vertexPosition() { return aPosition.xyz; }\n";
+                break;
+            case PositionSnorm16x4:
+                position = location + "ivec4 aPosition;\n"
+                           "vec3 vertexPosition() { return max(vec3(aPosition.xyz) / 32767.0, vec3(-1.0)); }\n";
+                break;
+            case ColorFloat4:
+            case ColorUnorm8x4:
+                color = location + "vec4 aColor;\n"
+                        "vec4 vertexColor() { return aColor; }\n";
+                break;
+            case NormalFloat3:
+                normal = location + "vec3 aNormal;\n"
+                         "vec3 vertexNormal() { return aNormal; }\n";
+                break;
+            case NormalOct16x2:
+                normal = location + "ivec2 aNormal;\n"
+                         "vec3 vertexNormal()\n"
+                         "{\n"
+                         "    vec2 e = max(vec2(aNormal) / 32767.0, vec2(-1.0));\n"
+                         "    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));\n"
+                         "    if(n.z < 0.0) n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);\n"
+                         "    return normalize(n);\n"
+                         "}\n";
+                break;
+        }
+    }
+
+    return "/* generated by vertexLayoutShaderHeader() */\n" + position + color + normal;
+}
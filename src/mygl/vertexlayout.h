@@ -0,0 +1,131 @@
+#pragma once
+
+#include "base.h"
+#include "math/bounds.h"
+
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+/* attribute locations, the per-instance model matrix occupies the four locations InstanceModel to InstanceModel + 3 */
+enum eDataIdx { Position = 0, Color = 1, InstanceModel = 2, InstanceColor = 6, Normal = 7 };
+
+struct Vertex
+{
+    Vector3D pos;
+    Vector4D color;
+};
+
+/* storage format of one vertex attribute, the prefix names the attribute it is bound to (see eDataIdx) */
+enum eAttribFormat
+{
+    PositionFloat3,     /* 12 bytes */
+    PositionHalf4,      /*  8 bytes, half floats relative to the mesh AABB, w unused */
+    PositionSnorm16x4,  /*  8 bytes, snorm16 relative to the mesh AABB, w unused */
+    ColorFloat4,        /* 16 bytes */
+    ColorUnorm8x4,      /*  4 bytes, RGBA8 */
+    NormalFloat3,       /* 12 bytes */
+    NormalOct16x2,      /*  4 bytes, octahedral encoding in two snorm16 */
+};
+
+struct VertexAttribute
+{
+    eAttribFormat format;
+    GLuint offset;
+};
+
+/* interleaved vertex format, the attribute setup, encoding and shader decoding are all derived from it */
+struct VertexLayout
+{
+    std::vector<VertexAttribute> attributes;
+    GLsizei stride = 0;
+};
+
+/**
+ * @brief Describe an interleaved vertex format, attributes are packed in the given order.
+ *
+ * @param formats At most one format per attribute (position, color, normal).
+ *
+ * @return Vertex layout.
+ *
+ * usage:
+ *
+ *   VertexLayout full = vertexLayoutCreate({PositionFloat3, ColorFloat4});          // 28 bytes, same as Vertex
+ *   VertexLayout compact = vertexLayoutCreate({PositionSnorm16x4, ColorUnorm8x4});  // 12 bytes
+ */
+VertexLayout vertexLayoutCreate(std::initializer_list<eAttribFormat> formats);
+
+/**
+ * @brief Size of one attribute in bytes.
+ *
+ * @param format Attribute format.
+ *
+ * @return Size in bytes.
+ */
+GLuint vertexAttribSize(eAttribFormat format);
+
+/**
+ * @brief Attribute location a format is bound to, all formats of one attribute share it.
+ *
+ * @param format Attribute format.
+ *
+ * @return Location (see eDataIdx).
+ */
+GLuint vertexAttribLocation(eAttribFormat format);
+
+/**
+ * @brief Check whether positions are stored relative to the mesh AABB and need the dequantization matrix (see
+ * vertexLayoutDequantization()).
+ *
+ * @param layout Vertex layout.
+ *
+ * @return true for quantized positions.
+ */
+bool vertexLayoutQuantized(const VertexLayout& layout);
+
+/**
+ * @brief Matrix mapping quantized positions in [-1, 1] back into the AABB they were encoded against (identity for
+ * float positions). Multiply it into the model matrix, so the shader needs no extra uniforms.
+ *
+ * @param layout Vertex layout.
+ * @param bounds Bounds the positions were encoded against.
+ *
+ * @return Dequantization matrix.
+ */
+Matrix4D vertexLayoutDequantization(const VertexLayout& layout, const AABB& bounds);
+
+/**
+ * @brief Encode vertices into the interleaved format of a layout.
+ *
+ * @param layout Vertex layout.
+ * @param bounds Bounds of the positions (used by quantized positions).
+ * @param vertices Positions and colors.
+ * @param normals Normal for each vertex, may be empty if the layout has no normal.
+ *
+ * @return layout.stride * vertices.size() bytes of vertex data.
+ */
+std::vector<unsigned char> vertexLayoutEncode(const VertexLayout& layout, const AABB& bounds, const std::vector<Vertex>& vertices,
+                                              const std::vector<Vector3D>& normals = {});
+
+/**
+ * @brief Enable and set up the attributes of a layout for the bound VAO and GL_ARRAY_BUFFER. Integer encodings
+ * (snorm16 positions, octahedral normals) use glVertexAttribIPointer and are decoded exactly in the shader.
+ *
+ * @param layout Vertex layout.
+ */
+void vertexLayoutSetup(const VertexLayout& layout);
+
+/**
+ * @brief Generate the GLSL declarations of the layout's inputs and the decode functions vec3 vertexPosition(),
+ * vec4 vertexColor() and vec3 vertexNormal() (constant defaults for attributes missing in the layout). Pass it as vertex
+ * header to shaderLoad(), it is inserted after the #version line.
+ *
+ * @param layout Vertex layout.
+ *
+ * @return GLSL source.
+ *
+ * usage:
+ *
+ *   ShaderProgram shader = shaderLoad("shader/quantized.vert", "shader/default.frag", vertexLayoutShaderHeader(layout));
+ */
+std::string vertexLayoutShaderHeader(const VertexLayout& layout);
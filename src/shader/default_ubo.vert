@@ -0,0 +1,30 @@
+#version 330 core
+
+layout(location = 0) in vec3 aPosition;
+layout(location = 1) in vec4 aColor;
+
+/* written once per frame, see CameraBlock in mygl/uniformbuffer.h */
+layout(std140) uniform CameraBlock
+{
+    mat4 uProj;
+    mat4 uView;
+    mat4 uViewProj;
+    vec4 uCameraPos;
+};
+
+/* one slot of the per-object ring, see ObjectBlock in mygl/uniformbuffer.h */
+layout(std140) uniform ObjectBlock
+{
+    mat4 uModel;
+};
+
+out vec4 tColor;
+out vec3 tFragPos;
+
+void main(void)
+{
+    vec4 worldPos = uModel * vec4(aPosition, 1.0);
+    gl_Position = uViewProj * worldPos;
+    tColor = aColor;
+    tFragPos = vec3(worldPos);
+}
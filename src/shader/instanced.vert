@@ -0,0 +1,28 @@
+#version 330 core
+
+layout(location = 0) in vec3 aPosition;
+layout(location = 1) in vec4 aColor;
+
+/* per-instance attributes, see InstanceData in mygl/mesh.h (the matrix uses locations 2 to 5) */
+layout(location = 2) in mat4 aInstanceModel;
+layout(location = 6) in vec4 aInstanceColor;
+
+/* written once per frame, see CameraBlock in mygl/uniformbuffer.h */
+layout(std140) uniform CameraBlock
+{
+    mat4 uProj;
+    mat4 uView;
+    mat4 uViewProj;
+    vec4 uCameraPos;
+};
+
+out vec4 tColor;
+out vec3 tFragPos;
+
+void main(void)
+{
+    vec4 worldPos = aInstanceModel * vec4(aPosition, 1.0);
+    gl_Position = uViewProj * worldPos;
+    tColor = aColor * aInstanceColor;
+    tFragPos = vec3(worldPos);
+}
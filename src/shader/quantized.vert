@@ -0,0 +1,30 @@
+#version 330 core
+
+/* the vertex inputs and vertexPosition(), vertexColor() and vertexNormal() are generated from the vertex layout of the
+ * mesh and inserted above, see vertexLayoutShaderHeader() in mygl/vertexlayout.h */
+
+/* written once per frame, see CameraBlock in mygl/uniformbuffer.h */
+layout(std140) uniform CameraBlock
+{
+    mat4 uProj;
+    mat4 uView;
+    mat4 uViewProj;
+    vec4 uCameraPos;
+};
+
+/* one slot of the per-object ring, the model matrix includes the dequantization of the mesh (Mesh::dequantization) */
+layout(std140) uniform ObjectBlock
+{
+    mat4 uModel;
+};
+
+out vec4 tColor;
+out vec3 tFragPos;
+
+void main(void)
+{
+    vec4 worldPos = uModel * vec4(vertexPosition(), 1.0);
+    gl_Position = uViewProj * worldPos;
+    tColor = vertexColor();
+    tFragPos = vec3(worldPos);
+}
@@ -0,0 +1,196 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "mygl/geometry.h"
+#include "mygl/meshfile.h"
+#include "mygl/meshimport.h"
+#include "mygl/meshoptimize.h"
+
+/* offline conversion of source geometry into the binary .mesh format loaded by meshLoad() */
+
+namespace
+{
+
+void printUsage()
+{
+    std::cout << "usage: meshconvert <input> <output.mesh> [--layout full|compact] [--no-optimize]\n"
+                 "       meshconvert --info <file.mesh>\n"
+                 "\n"
+                 "inputs:  .obj, .ply, cube, quad (built-in geometry)\n"
+                 "layouts: full    = PositionFloat3 + ColorFloat4 [+ NormalFloat3] (28 [40] bytes per vertex)\n"
+                 "         compact = PositionSnorm16x4 + ColorUnorm8x4 [+ NormalOct16x2] (12 [16] bytes per vertex, default)\n";
+}
+
+bool loadSource(const std::string& input, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices, std::vector<Vector3D>& normals)
+{
+    if(input.size() > 4 && (input.compare(input.size() - 4, 4, ".obj") == 0 || input.compare(input.size() - 4, 4, ".ply") == 0))
+    {
+        MeshImportStats stats;
+        meshImport(input, vertices, indices, &normals, &stats);
+        std::cout << "imported " << vertices.size() << " vertices, " << indices.size() / 3 << " triangles: " << toString(stats) << std::endl;
+        return true;
+    }
+    if(input == "cube")
+    {
+        vertices = cube::vertices;
+        indices = cube::indices;
+        return true;
+    }
+    if(input == "quad")
+    {
+        for(const Vector3D& p : quad::vertexPos)
+        {
+            vertices.push_back({p, Vector4D(1.0f, 1.0f, 1.0f, 1.0f)});
+        }
+        indices = quad::indices;
+        return true;
+    }
+    return false;
+}
+
+const char* formatName(uint32_t format)
+{
+    switch(format)
+    {
+        case PositionFloat3:    return "PositionFloat3";
+        case PositionHalf4:     return "PositionHalf4";
+        case PositionSnorm16x4: return "PositionSnorm16x4";
+        case ColorFloat4:       return "ColorFloat4";
+        case ColorUnorm8x4:     return "ColorUnorm8x4";
+        case NormalFloat3:      return "NormalFloat3";
+        case NormalOct16x2:     return "NormalOct16x2";
+    }
+    return "unknown";
+}
+
+void printInfo(const std::string& filepath)
+{
+    MeshFile file = meshFileOpen(filepath);
+    const MeshFileHeader& header = *file.header;
+
+    std::cout << filepath << ": version " << header.version << ", " << file.mapped.size << " bytes\n"
+              << "  vertices: " << header.vertexCount << " x " << header.vertexStride << " bytes\n"
+              << "  indices:  " << header.indexCount << " x " << header.indexSize << " bytes\n"
+              << "  bounds:   " << toString(AABB{Vector3D(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]),
+                                                 Vector3D(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2])}) << "\n";
+    for(uint32_t i = 0; i < header.attributeCount; i++)
+    {
+        std::cout << "  attribute " << i << ": " << formatName(file.attributes[i].format) << " at offset " << file.attributes[i].offset << "\n";
+    }
+
+    meshFileClose(file);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    if(argc == 3 && std::strcmp(argv[1], "--info") == 0)
+    {
+        try
+        {
+            printInfo(argv[2]);
+        }
+        catch(const std::exception&)
+        {
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    if(argc < 3)
+    {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    const std::string input = argv[1];
+    const std::string output = argv[2];
+    bool compact = true;
+    bool optimize = true;
+
+    for(int i = 3; i < argc; i++)
+    {
+        std::string option = argv[i];
+        if(option == "--layout" && i + 1 < argc)
+        {
+            std::string name = argv[++i];
+            compact = name == "compact";
+            if(name != "full" && name != "compact")
+            {
+                std::cerr << "unknown layout " << name << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if(option == "--no-optimize")
+        {
+            optimize = false;
+        }
+        else
+        {
+            printUsage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    std::vector<Vector3D> normals;
+    try
+    {
+        if(!loadSource(input, vertices, indices, normals))
+        {
+            std::cerr << "unknown input " << input << std::endl;
+            printUsage();
+            return EXIT_FAILURE;
+        }
+    }
+    catch(const std::exception&)
+    {
+        return EXIT_FAILURE;
+    }
+
+    VertexLayout layout;
+    if(normals.empty())
+    {
+        layout = compact ? vertexLayoutCreate({PositionSnorm16x4, ColorUnorm8x4}) : vertexLayoutCreate({PositionFloat3, ColorFloat4});
+    }
+    else
+    {
+        layout = compact ? vertexLayoutCreate({PositionSnorm16x4, ColorUnorm8x4, NormalOct16x2})
+                         : vertexLayoutCreate({PositionFloat3, ColorFloat4, NormalFloat3});
+    }
+
+    if(optimize && normals.empty())
+    {
+        std::cout << toString(meshOptimize(vertices, indices)) << std::endl;
+    }
+    else if(optimize)
+    {
+        /* the vertex passes of meshOptimize() do not know about normals, reordering the triangles is still safe */
+        float acmrBefore = meshACMR(indices, (unsigned int) vertices.size());
+        meshOptimizeVertexCache(vertices, indices);
+        std::cout << "ACMR: " << acmrBefore << " -> " << meshACMR(indices, (unsigned int) vertices.size()) << std::endl;
+    }
+
+    try
+    {
+        meshFileWrite(output, layout, vertices, indices, normals);
+        printInfo(output);
+    }
+    catch(const std::exception&)
+    {
+        return EXIT_FAILURE;
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "converted " << input << " in " << ms << " ms" << std::endl;
+    return EXIT_SUCCESS;
+}